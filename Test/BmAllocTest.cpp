@@ -1,7 +1,6 @@
 #include <Windows.h>
 #include <cstdlib>
 #include <cstdio>
-#include <cmath>
 
 #include "BmAlloc.hpp"
 #include "../Windows_RwSpinLock.hpp"
@@ -13,7 +12,47 @@ DWORD WINAPI procedure (LPVOID);
 
 std::uint64_t sum = 0u;
 std::intptr_t data [32];
-std::uint64_t sss [256] = { 0 };
+
+// wait profile totals, indexed by Windows::RwSpinLockPhase
+
+const char * phases [5] = { "pause", "yield", "sleep0", "sleep1", "park" };
+
+struct Waits {
+    std::uint64_t uncontended = 0;
+    std::uint64_t deepest [5] = {}; // number of acquisitions that waited up to this phase
+    std::uint64_t rounds [5] = {};
+    std::uint64_t elapsed [5] = {}; // nanoseconds
+
+    void add (const Windows::RwSpinLockWaitProfile & profile) {
+        if (profile.Rounds ()) {
+            auto phase = 4;
+            while (!profile.count [phase]) {
+                --phase;
+            }
+            ++this->deepest [phase];
+        } else {
+            ++this->uncontended;
+        }
+        for (auto i = 0; i != 5; ++i) {
+            this->rounds [i] += profile.count [i];
+            this->elapsed [i] += profile.elapsed [i];
+        }
+    }
+    void add (const Waits & other) {
+        this->uncontended += other.uncontended;
+        for (auto i = 0; i != 5; ++i) {
+            this->deepest [i] += other.deepest [i];
+            this->rounds [i] += other.rounds [i];
+            this->elapsed [i] += other.elapsed [i];
+        }
+    }
+    std::uint64_t contended () const {
+        return this->deepest [0] + this->deepest [1] + this->deepest [2] + this->deepest [3] + this->deepest [4];
+    }
+    std::uint64_t waited () const {
+        return this->elapsed [0] + this->elapsed [1] + this->elapsed [2] + this->elapsed [3] + this->elapsed [4];
+    }
+} waits;
 
 BmAlloc allocator (data, 8 * sizeof (std::intptr_t) * sizeof data / sizeof data [0]);
 
@@ -29,12 +68,16 @@ SRWLOCK srw = SRWLOCK_INIT;
 Windows::RwSpinLock lock;
 HANDLE mutex = CreateMutex (NULL, FALSE, NULL);
 
+int Policies (); // Policies.cpp
+
 int main (int argc, char ** argv) {
     InitializeCriticalSection (&cs);
 
     // command-line "BmAllocTest 0" = SRLOCK, "BmAllocTest 1" = RwSpinLock
+    //  - "BmAllocTest policies" runs instantiation test of the Stats policies instead
 
     if (argc > 1) {
+        if (std::strcmp (argv [1], "policies") == 0) return Policies () ? 1 : 0;
         if (std::strcmp (argv [1], "spinlock") == 0) algorithm = algorithm::spinlock;
         if (std::strcmp (argv [1], "srw") == 0) algorithm = algorithm::srw;
         if (std::strcmp (argv [1], "cs") == 0) algorithm = algorithm::cs;
@@ -73,40 +116,26 @@ int main (int argc, char ** argv) {
     std::printf ("\nRESULT: %llu/s\n", sum * 1000 / (GetTickCount64 () - t0));
 
 
-    const auto rows = 10;
-    for (auto row = 0; row < rows; ++row) {
-        std::printf ("    ");
-
-        auto m = std::pow (10, rows - row - 1);
-
-        // 0
-        std::printf ("%c", (sss [0] > m) ? '0' : ' ');
+    if (algorithm == algorithm::spinlock) {
+        auto contended = waits.contended ();
+        auto waited = waits.waited ();
 
-        // 1 - 128
-        auto i = 1;
-        for (; i < 124; i += 3) {
-            auto sm = sss [i] + sss [i + 1] + sss [i + 2];
-            std::printf ("%c", (sm > m) ? 'Y' : ' ');
-        }
-
-        // sleeps
-        for (; i < 128; i += 1) {
-            std::printf ("%c", (sss [i] > m) ? 'S' : ' ');
-        }
+        std::printf ("\nuncontended: %llu, contended: %llu, waited: %.3f ms\n\n",
+                     waits.uncontended, contended, waited / 1000000.0);
+        std::printf ("    %-8s %12s %12s %12s %8s\n", "phase", "deepest", "rounds", "time ms", "time %");
 
-        // rest
-        for (; i < sizeof sss / sizeof sss [0] - 3; i += 4) {
-            auto sm = sss [i] + sss [i + 1] + sss [i + 2] + sss [i + 3];
-            std::printf ("%c", (sm > m) ? '1' : ' ');
+        for (auto i = 0; i != 5; ++i) {
+            std::printf ("    %-8s %12llu %12llu %12.3f %8.2f\n",
+                         phases [i], waits.deepest [i], waits.rounds [i], waits.elapsed [i] / 1000000.0,
+                         waited ? waits.elapsed [i] * 100.0 / waited : 0.0);
         }
-        std::printf ("\n");
     }
     return 0;
 }
 
 DWORD WINAPI procedure (LPVOID) {
     std::uint64_t na = 0uLL;
-    std::uint64_t spins [256] = { 0 };
+    Waits profiled;
 
     while (!quit) {
 
@@ -121,21 +150,17 @@ DWORD WINAPI procedure (LPVOID) {
         auto i = 0u;
         for (; i != n; ++i) {
             
-            std::uint32_t rounds = 0u;
+            Windows::RwSpinLockWaitProfile profile;
             switch (algorithm) {
                 case algorithm::spinlock:
-                    if (auto guard = lock.exclusively (&rounds)) {
+                    if (auto guard = lock.exclusively (profile)) {
                         if (allocator.acquire (&a [i])) {
                             ++na;
                         } else {
                             std::printf ("%u: ERROR at %u/%u after %llu\n", GetCurrentThreadId (), (unsigned) i, (unsigned) n, na);
                         }
                     }
-                    if (rounds > sizeof spins / sizeof spins [0] - 1) {
-                        rounds = sizeof spins / sizeof spins [0] - 1;
-                    }
-
-                    ++spins [rounds];
+                    profiled.add (profile);
                     break;
                 case algorithm::srw:
                     AcquireSRWLockExclusive (&srw);
@@ -170,10 +195,9 @@ DWORD WINAPI procedure (LPVOID) {
         // and release
 
         while (i--) {
-            std::uint32_t rounds = 0u;
             switch (algorithm) {
                 case algorithm::spinlock:
-                    if (auto guard = lock.exclusively (&rounds)) {
+                    if (auto guard = lock.exclusively ()) {
                         allocator.release (a [i]);
                     }
                     break;
@@ -207,29 +231,17 @@ DWORD WINAPI procedure (LPVOID) {
                 break;
             
             case algorithm::spinlock:
-                std::uint64_t allspins = 0;
-                std::uint64_t highspins = 0;
-                std::uint64_t totalspins = 0;
-
-                sss [0] += spins [0];
-                for (auto i = 1u; i != sizeof spins / sizeof spins [0]; ++i) {
-                    sss [i] += spins [i];
-
-                    if (spins [i]) {
-                        ++allspins;
-                        totalspins += spins [i];
-                        if (i >= 125) {
-                            highspins += spins [i];
-                        }
-                    }
-                }
+                waits.add (profiled);
+
+                auto contended = profiled.contended ();
+                auto acquisitions = profiled.uncontended + contended;
 
-                std::printf ("[%6u:%10llu] spins: 0 = %llu, total = %llu, high = %llu, any = %llu (total: %.3f%%, high: %.3f%%, any: %.3f%%)\n",
+                std::printf ("[%6u:%10llu] contended: %llu (%.3f%%), sleeping: %llu (%.3f%%), waited: %.3f ms\n",
                              GetCurrentThreadId (), na,
-                             spins [0], totalspins, highspins, allspins,
-                             totalspins * 100.0 / spins [0],
-                             highspins * 100.0 / spins [0],
-                             allspins * 100.0 / spins [0]);
+                             contended, contended * 100.0 / acquisitions,
+                             contended - profiled.deepest [0] - profiled.deepest [1],
+                             (contended - profiled.deepest [0] - profiled.deepest [1]) * 100.0 / acquisitions,
+                             profiled.waited () / 1000000.0);
                 break;
         }
     }
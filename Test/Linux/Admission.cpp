@@ -0,0 +1,73 @@
+#include <Windows.h>
+#include "../../Windows_RwSpinLock.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+// Admission
+//  - test of RwSpinLockAdmission (Malthusian admission control) passive waiters
+//  - a writer occupies the single active place while readers hold the lock, a culled reader must still get in,
+//    as the lock is available for sharing, even though it never becomes free
+//  - exits with non-zero code on failure, run by ctest
+//
+namespace {
+    int failures = 0;
+
+    void Check (bool condition, const char * what) {
+        std::printf ("%s: %s\n", condition ? "ok" : "FAILED", what);
+        if (!condition) {
+            ++failures;
+        }
+    }
+}
+
+int main () {
+    Windows::RwSpinLock <long> lock;
+    std::atomic <int> writer { 0 };  // 0 - waiting, 1 - acquired, -1 - timed out
+    std::atomic <int> reader { 0 };
+    Windows::RwSpinLockWaitProfile profile;
+
+    // single active place, no rotation
+    Windows::RwSpinLockAdmission::Enable (1, 0x7FFFFFFF);
+    lock.AcquireExclusive ();
+
+    std::thread w ([&] {
+        if (lock.AcquireExclusive (std::uint64_t (5000))) {
+            writer = 1;
+            lock.ReleaseExclusive ();
+        } else {
+            writer = -1;
+        }
+    });
+    Sleep (50);
+
+    std::thread r ([&] {
+        if (lock.AcquireShared (std::uint64_t (2000), profile)) {
+            lock.ReleaseShared ();
+            reader = 1;
+        } else {
+            reader = -1;
+        }
+    });
+    Sleep (50);
+
+    // readers keep holding the lock from now on, it is never free again until the reader gets in
+    lock.DowngradeToShared ();
+    for (auto i = 0; i != 3000 && reader == 0; ++i) {
+        Sleep (1);
+    }
+
+    Check (reader == 1, "culled reader acquires shared lock held by other readers");
+    Check (profile.count [(int) Windows::RwSpinLockPhase::Park] != 0, "the reader was parked in the passive set");
+    Check (writer == 0, "writer keeps waiting while readers hold the lock");
+
+    lock.ReleaseShared ();
+    w.join ();
+    r.join ();
+    Windows::RwSpinLockAdmission::Disable ();
+
+    Check (writer == 1, "writer acquires the lock after the readers leave");
+    Check (!lock.IsLocked (), "lock is released");
+    return failures ? 1 : 0;
+}
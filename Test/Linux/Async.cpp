@@ -0,0 +1,149 @@
+#include <Windows.h>
+#include "../../Windows_RwSpinLockAsync.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <optional>
+#include <thread>
+#include <vector>
+
+// Async
+//  - demonstration and test of async_exclusively/async_share, over the thread pool timer emulation of the shim
+//  - tests that available lock is granted from the calling thread, that contended acquisition completes
+//    on the thread pool after release, and that the rounds it took are reported to Stats policy
+//  - exits with non-zero code on failure, run by ctest
+//
+namespace {
+
+    // Rounds
+    //  - Stats policy remembering rounds of the last acquisition
+    //
+    struct Rounds : Windows::RwSpinLockNoStatistics {
+        static inline std::atomic <std::uint32_t> last { 0 };
+
+        static inline void Acquired (const void *, Windows::RwSpinLockMode, std::uint32_t rounds) noexcept {
+            last.store (rounds);
+        }
+    };
+
+    using Lock = Windows::RwSpinLock <short, Rounds>;
+
+    int failures = 0;
+
+    void Check (bool condition, const char * what) {
+        std::printf ("%s: %s\n", condition ? "ok" : "FAILED", what);
+        if (!condition) {
+            ++failures;
+        }
+    }
+
+    // Wait
+    //  - waits for 'flag' up to a second, the event loop would be running other work meanwhile
+    //
+    bool Wait (const std::atomic <bool> & flag) {
+        for (auto i = 0; i != 1000 && !flag.load (); ++i) {
+            Sleep (1);
+        }
+        return flag.load ();
+    }
+}
+
+int main () {
+    const auto loop = std::this_thread::get_id ();
+
+    // available lock, callback runs immediately
+
+    {
+        Lock lock;
+        std::thread::id thread;
+        auto started = Windows::async_exclusively (lock, [&] (auto) noexcept {
+            thread = std::this_thread::get_id ();
+        });
+
+        Check (started && thread == loop, "available lock is granted from the calling thread");
+        Check (Rounds::last == 0, "immediate acquisition reports no rounds");
+        Check (!lock.IsLocked (), "lock is released when the callback returns");
+    }
+
+    // contended exclusive acquisition, completes on the thread pool
+
+    {
+        Lock lock;
+        std::atomic <bool> done { false };
+        std::thread::id thread;
+
+        lock.AcquireExclusive ();
+        auto started = Windows::async_exclusively (lock, [&] (auto) noexcept {
+            thread = std::this_thread::get_id ();
+            done.store (true);
+        });
+        Sleep (20);
+
+        Check (started && !done, "contended acquisition is deferred");
+        lock.ReleaseExclusive ();
+
+        Check (Wait (done) && thread != loop, "callback runs on the thread pool after release");
+        Check (Rounds::last != 0, "deferred acquisition reports rounds spent waiting");
+        Check (!lock.IsLocked (), "lock is released when the callback returns");
+    }
+
+    // shared acquisition kept past the callback, by moving the guard away
+
+    {
+        Lock lock;
+        std::atomic <bool> done { false };
+        std::optional <Windows::RwSpinLockScopeShared <short, Rounds>> kept;
+
+        lock.AcquireExclusive ();
+        auto started = Windows::async_share (lock, [&] (auto guard) noexcept {
+            kept.emplace (std::move (guard));
+            done.store (true);
+        });
+        lock.ReleaseExclusive ();
+
+        Check (started && Wait (done), "shared acquisition completes");
+        Check (lock.IsLocked () && !lock.IsLockedExclusively (), "moved guard keeps the shared lock");
+        kept.reset ();
+        Check (!lock.IsLocked (), "lock is released with the moved guard");
+    }
+
+    // many pending acquisitions against blocking threads
+
+    {
+        static constexpr unsigned Requests = 200;
+        static constexpr unsigned Iterations = 20000;
+
+        Lock lock;
+        unsigned value = 0;
+        std::atomic <unsigned> completed { 0 };
+        std::vector <std::thread> threads;
+
+        for (auto i = 0; i != 2; ++i) {
+            threads.emplace_back ([&] {
+                for (auto n = 0u; n != Iterations; ++n) {
+                    lock.AcquireExclusive ();
+                    ++value;
+                    lock.ReleaseExclusive ();
+                }
+            });
+        }
+
+        auto started = 0u;
+        for (auto i = 0u; i != Requests; ++i) {
+            started += Windows::async_exclusively (lock, [&] (auto) noexcept {
+                ++value;
+                completed.fetch_add (1);
+            });
+        }
+        for (auto & thread : threads) {
+            thread.join ();
+        }
+        for (auto i = 0; i != 1000 && completed.load () != Requests; ++i) {
+            Sleep (1);
+        }
+
+        Check (started == Requests && completed == Requests, "all pending acquisitions complete");
+        Check (value == 2 * Iterations + Requests, "no update is lost");
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,174 @@
+#include "Bench.hpp"
+#include "Mixed.hpp"
+#include "Histogram.hpp"
+#include "../../Windows_RwSpinLockAsync.hpp"
+
+#include <optional>
+
+// AsyncWait
+//  - latency of async_exclusively/async_share against blocking acquisition, spin locks only
+//  - runs the Mixed workload of rw-sweep with --threads threads, for every --reads percentage, once with
+//    blocking AcquireExclusive/AcquireShared and once with asynchronous acquisition
+//  - asynchronous wait is measured from the request until the requesting thread learns of the callback,
+//    thus includes the hand-off from the thread pool; the requesting thread only yields meanwhile,
+//    where an event loop would run other work
+//  - reports one row per lock, read percentage, acquisition and mode with mean, p50, p99, p99.9 and max
+//    in nanoseconds, and percentage of asynchronous acquisitions deferred to the thread pool
+//
+namespace {
+    struct Recorder {
+        Bench::Histogram shared;
+        Bench::Histogram exclusive;
+    };
+
+    // Async
+    //  - per-thread adapter acquiring 'inner' through async_exclusively/async_share, and waiting for the callback,
+    //    which moves the guard out, so that the lock stays held until unlock/unlock_shared
+    //  - falls back to blocking acquisition if the thread pool timer couldn't be allocated
+    //
+    template <typename Spin>
+    struct Async {
+        Spin & inner;
+        std::optional <decltype (std::declval <Spin &> ().try_exclusively ())> exclusive;
+        std::optional <decltype (std::declval <Spin &> ().try_share ())> shared;
+        std::atomic <bool> done { false };
+        std::thread::id requester = std::this_thread::get_id ();
+        std::uint64_t requests = 0;
+        std::uint64_t deferred = 0;
+
+        explicit Async (Spin & inner) : inner (inner) {}
+
+        void lock () noexcept {
+            this->done.store (false, std::memory_order_relaxed);
+            if (Windows::async_exclusively (this->inner, [this] (auto guard) noexcept {
+                    this->exclusive.emplace (std::move (guard));
+                    this->Complete ();
+                })) {
+                this->Wait ();
+            } else {
+                this->exclusive.emplace (this->inner.exclusively ());
+            }
+        }
+        void unlock () noexcept { this->exclusive.reset (); }
+
+        void lock_shared () noexcept {
+            this->done.store (false, std::memory_order_relaxed);
+            if (Windows::async_share (this->inner, [this] (auto guard) noexcept {
+                    this->shared.emplace (std::move (guard));
+                    this->Complete ();
+                })) {
+                this->Wait ();
+            } else {
+                this->shared.emplace (this->inner.share ());
+            }
+        }
+        void unlock_shared () noexcept { this->shared.reset (); }
+
+    private:
+        void Complete () noexcept {
+            if (std::this_thread::get_id () != this->requester) {
+                ++this->deferred;
+            }
+            this->done.store (true, std::memory_order_release);
+        }
+        void Wait () noexcept {
+            ++this->requests;
+            while (!this->done.load (std::memory_order_acquire)) {
+                std::this_thread::yield ();
+            }
+        }
+    };
+
+    template <typename Spin>
+    struct Blocking {
+        Spin & inner;
+
+        void lock () noexcept { this->inner.AcquireExclusive (); }
+        void unlock () noexcept { this->inner.ReleaseExclusive (); }
+        void lock_shared () noexcept { this->inner.AcquireShared (); }
+        void unlock_shared () noexcept { this->inner.ReleaseShared (); }
+    };
+}
+
+bool Bench::AsyncWait (const Options & options, Report & report) {
+    auto reads = Numbers (options.reads);
+    if (reads.empty () || options.work == 0) {
+        std::fprintf (stderr, "invalid --reads list or --work\n");
+        return false;
+    }
+
+    const auto frequency = Windows::RwSpinLockTimestampFrequency () / 1e9; // units per nanosecond
+    const auto threads = options.threads;
+
+    ForEachSpinLock (options, [&] (auto tag) {
+        using Lock = typename decltype (tag)::type;
+        using Spin = decltype (Lock::spin);
+
+        for (auto percent : reads) {
+            for (auto async : { false, true }) {
+                auto lock = std::make_unique <Lock> ();
+                std::vector <std::uint64_t> table (options.work);
+                std::vector <Recorder> recorders (threads);
+                std::vector <Counters> checksums (threads);
+                std::vector <Counters> requests (threads);
+                std::vector <Counters> deferred (threads);
+
+                auto seconds = Run (options, threads, options.duration, [&] (unsigned index, const std::atomic <bool> & stop) {
+                    auto & recorder = recorders [index];
+                    auto record = [&recorder] (bool shared, std::uint64_t wait) {
+                        if (shared) {
+                            recorder.shared.Record (wait);
+                        } else {
+                            recorder.exclusive.Record (wait);
+                        }
+                    };
+
+                    if (async) {
+                        Async <Spin> adapter (lock->spin);
+                        checksums [index].operations = Mixed (adapter, table, percent, index, stop, record);
+                        requests [index].operations = adapter.requests;
+                        deferred [index].operations = adapter.deferred;
+                    } else {
+                        Blocking <Spin> adapter { lock->spin };
+                        checksums [index].operations = Mixed (adapter, table, percent, index, stop, record);
+                    }
+                });
+
+                Recorder total;
+                std::uint64_t issued = 0;
+                std::uint64_t pooled = 0;
+                for (auto i = 0u; i != threads; ++i) {
+                    total.shared.Merge (recorders [i].shared);
+                    total.exclusive.Merge (recorders [i].exclusive);
+                    issued += requests [i].operations;
+                    pooled += deferred [i].operations;
+                }
+
+                for (auto shared : { true, false }) {
+                    const auto & histogram = shared ? total.shared : total.exclusive;
+                    if (histogram.Count () == 0)
+                        continue;
+
+                    report.Row ({
+                        { "mode", "async" },
+                        { "lock", Lock::name },
+                        { "width", Lock::width },
+                        { "threads", threads },
+                        { "read_pct", percent },
+                        { "wait", async ? "async" : "blocking" },
+                        { "acquire", shared ? "shared" : "exclusive" },
+                        { "seconds", seconds },
+                        { "count", histogram.Count () },
+                        { "deferred_pct", issued ? 100.0 * pooled / issued : 0.0 },
+                        { "mean_ns", histogram.Mean () / frequency },
+                        { "p50_ns", histogram.Percentile (50.0) / frequency },
+                        { "p99_ns", histogram.Percentile (99.0) / frequency },
+                        { "p999_ns", histogram.Percentile (99.9) / frequency },
+                        { "max_ns", histogram.Max () / frequency },
+                    });
+                }
+            }
+        }
+    });
+    return true;
+}
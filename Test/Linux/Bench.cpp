@@ -0,0 +1,244 @@
+#include "Bench.hpp"
+#include <cerrno>
+#include <cmath>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+    // Count
+    //  - parses non-negative decimal number that fits 'unsigned', returns false otherwise
+    //
+    bool Count (const std::string & value, unsigned & result) {
+        if (value.empty () || value.find_first_not_of ("0123456789") != std::string::npos)
+            return false;
+
+        errno = 0;
+        auto n = std::strtoul (value.c_str (), nullptr, 10);
+        if (errno == ERANGE || n > UINT_MAX)
+            return false;
+
+        result = unsigned (n);
+        return true;
+    }
+}
+
+bool Bench::ParseWorkload (const std::string & name, WorkloadKind & kind) {
+    if (name == "bmalloc") {
+        kind = WorkloadKind::bmalloc;
+        return true;
+    }
+    if (name == "counter") {
+        kind = WorkloadKind::counter;
+        return true;
+    }
+    return false;
+}
+
+bool Bench::Options::Parse (int argc, char ** argv, std::string & error) {
+    for (auto i = 1; i < argc; ++i) {
+        std::string argument = argv [i];
+        if (argument.compare (0, 2, "--") != 0) {
+            error = "unexpected argument: " + argument;
+            return false;
+        }
+
+        std::string name = argument.substr (2);
+        std::string value;
+
+        auto equals = name.find ('=');
+        if (equals != std::string::npos) {
+            value = name.substr (equals + 1);
+            name.resize (equals);
+        } else
+        if (i + 1 < argc) {
+            value = argv [++i];
+        } else {
+            error = "missing value of --" + name;
+            return false;
+        }
+
+        auto valid = true;
+
+        if (name == "mode") this->mode = value; else
+        if (name == "lock") this->lock = value; else
+        if (name == "workload") this->workload = value; else
+        if (name == "format") this->format = value; else
+        if (name == "pin") this->pin = value; else
+        if (name == "duration") this->duration = std::atof (value.c_str ()); else
+        if (name == "threads") valid = Count (value, this->threads); else
+        if (name == "reads") this->reads = value; else
+        if (name == "work") valid = Count (value, this->work); else
+        if (name == "histograms") this->histograms = value; else
+        if (name == "factors") this->factors = value; else
+        if (name == "cores") this->cores = value; else
+        if (name == "writers") valid = Count (value, this->writers); else
+        if (name == "iterations") valid = Count (value, this->iterations); else
+        if (name == "inside") this->inside = value; else
+        if (name == "outside") this->outside = value; else {
+            error = "unknown option --" + name;
+            return false;
+        }
+
+        if (!valid) {
+            error = "invalid value of --" + name + ": " + value;
+            return false;
+        }
+    }
+
+    if (!ParseWorkload (this->workload, this->kind)) {
+        error = "unknown workload: " + this->workload;
+        return false;
+    }
+
+    if (this->format != "csv" && this->format != "json") {
+        error = "unknown format: " + this->format;
+        return false;
+    }
+    if (this->pin != "compact" && this->pin != "none") {
+        error = "unknown pinning: " + this->pin;
+        return false;
+    }
+    if (!(this->duration > 0.0)) {
+        error = "duration must be positive";
+        return false;
+    }
+    if (this->threads == 0) {
+        this->threads = (unsigned) std::max <std::size_t> (1, Cpus ().size ());
+    }
+    return true;
+}
+
+bool Bench::Options::Selected (const char * name) const {
+    if (this->lock == "all")
+        return true;
+
+    auto length = std::strlen (name);
+    std::size_t begin = 0;
+    while (begin <= this->lock.size ()) {
+        auto end = this->lock.find (',', begin);
+        if (end == std::string::npos) {
+            end = this->lock.size ();
+        }
+        if (end - begin == length && this->lock.compare (begin, length, name) == 0)
+            return true;
+
+        begin = end + 1;
+    }
+    return false;
+}
+
+Bench::Field::Field (const char * name, double value)
+    : name (name)
+    , text (false) {
+
+    if (std::isfinite (value)) {
+        char buffer [32];
+        std::snprintf (buffer, sizeof buffer, "%.6g", value);
+        this->value = buffer;
+    }
+}
+
+Bench::Report::Report (const std::string & format, std::FILE * output)
+    : output (output)
+    , json (format == "json") {}
+
+Bench::Report::~Report () {
+    if (this->json) {
+        std::fprintf (this->output, this->rows ? "\n]\n" : "[]\n");
+    }
+    std::fflush (this->output);
+}
+
+void Bench::Report::Row (const std::vector <Field> & fields) {
+    if (this->json) {
+        std::fprintf (this->output, this->rows ? ",\n  {" : "[\n  {");
+        for (auto i = 0u; i != fields.size (); ++i) {
+            const auto & field = fields [i];
+            std::fprintf (this->output, "%s\"%s\": ", i ? ", " : "", field.name);
+            if (field.text) {
+                std::fprintf (this->output, "\"%s\"", field.value.c_str ());
+            } else if (field.value.empty ()) {
+                std::fprintf (this->output, "null");
+            } else {
+                std::fprintf (this->output, "%s", field.value.c_str ());
+            }
+        }
+        std::fprintf (this->output, "}");
+    } else {
+        std::vector <std::string> names;
+        for (const auto & field : fields) {
+            names.push_back (field.name);
+        }
+        if (names != this->header) {
+            this->header = names;
+            for (auto i = 0u; i != names.size (); ++i) {
+                std::fprintf (this->output, "%s%s", i ? "," : "", names [i].c_str ());
+            }
+            std::fprintf (this->output, "\n");
+        }
+        for (auto i = 0u; i != fields.size (); ++i) {
+            std::fprintf (this->output, "%s%s", i ? "," : "", fields [i].value.c_str ());
+        }
+        std::fprintf (this->output, "\n");
+    }
+    std::fflush (this->output);
+    ++this->rows;
+}
+
+std::vector <double> Bench::Numbers (const std::string & list) {
+    std::vector <double> numbers;
+    const char * p = list.c_str ();
+    while (*p) {
+        char * end;
+        numbers.push_back (std::strtod (p, &end));
+        if (end == p || (*end && *end != ','))
+            return {};
+
+        p = *end ? end + 1 : end;
+    }
+    return numbers;
+}
+
+std::vector <unsigned> Bench::Sweep (unsigned threads) {
+    std::vector <unsigned> counts;
+    for (auto n = 1u; n < threads; n *= 2) {
+        counts.push_back (n);
+    }
+    counts.push_back (threads);
+    return counts;
+}
+
+std::vector <int> Bench::Cpus () {
+    std::vector <int> cpus;
+    cpu_set_t set;
+    CPU_ZERO (&set);
+    if (sched_getaffinity (0, sizeof set, &set) == 0) {
+        for (auto cpu = 0; cpu != CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET (cpu, &set)) {
+                cpus.push_back (cpu);
+            }
+        }
+    }
+    return cpus;
+}
+
+bool Bench::Pin (std::thread & thread, int cpu) {
+    cpu_set_t set;
+    CPU_ZERO (&set);
+    CPU_SET (cpu, &set);
+    return pthread_setaffinity_np (thread.native_handle (), sizeof set, &set) == 0;
+}
+
+std::string Bench::LockNames () {
+    std::string names;
+    Options all;
+    ForEachLock (all, [&names] (auto tag) {
+        if (!names.empty ()) {
+            names += ", ";
+        }
+        names += decltype (tag)::type::name;
+    });
+    return names;
+}
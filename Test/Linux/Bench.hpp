@@ -0,0 +1,335 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <Windows.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+
+#include "../../Windows_RwSpinLock.hpp"
+#include "../../Windows_RwSpinLockStatistics.hpp"
+
+namespace Bench {
+
+    // WorkloadKind
+    //  - critical section of the workload-based modes, see Workload
+    //
+    enum class WorkloadKind {
+        bmalloc,
+        counter
+    };
+
+    // ParseWorkload
+    //  - returns false for unknown workload name
+    //
+    bool ParseWorkload (const std::string & name, WorkloadKind & kind);
+
+    // Options
+    //  - command-line options common to all modes, "--name=value" or "--name value"
+    //
+    struct Options {
+        std::string mode = "throughput";
+        std::string lock = "all";           // lock name, comma separated list, or "all", see Locks
+        std::string workload = "bmalloc";   // see Workload
+        WorkloadKind kind = WorkloadKind::bmalloc; // parsed --workload
+        std::string format = "csv";         // csv, json
+        std::string pin = "compact";        // compact - thread i on i-th allowed CPU, none - leave to the scheduler
+        double duration = 2.0;              // seconds, per measurement
+        unsigned threads = 0;               // 0 - number of allowed CPUs
+        std::string reads = "0,50,90,99,100"; // rw-sweep: percentages of shared acquisitions
+        unsigned work = 64;                 // rw-sweep: words read (or written) under the lock
+        std::string histograms;             // latency: directory to write .hgrm files into, none if empty
+        std::string factors = "1,2,4,8";    // oversubscribe: threads per core
+        std::string cores;                  // oversubscribe: numbers of CPUs to confine to, empty - all, half and one
+        unsigned writers = 0;               // fairness, upgrade: threads that only write/insert, 0 - quarter of --threads
+        unsigned iterations = 1000000;      // fastpath: operations per timed loop
+        std::string inside = "0,10,30,100,300,1000,3000,10000"; // cs-sweep: critical section lengths, ns
+        std::string outside = "0,100,1000,10000";               // cs-sweep: delays between acquisitions, ns
+
+        // Parse
+        //  - returns false on unknown option, missing or invalid value, 'error' then describes it
+        //  - counts (--threads, --work, ...) must be non-negative decimal numbers
+        //
+        bool Parse (int argc, char ** argv, std::string & error);
+
+        // Selected
+        //  - true if lock 'name' was selected by the --lock option
+        //
+        bool Selected (const char * name) const;
+    };
+
+    // Field
+    //  - single named value of a Report row, numbers are written unquoted
+    //  - non-finite numbers (e.g. ratio with zero denominator) have empty value, written as null into json
+    //
+    struct Field {
+        const char * name;
+        std::string value;
+        bool text;
+
+        Field (const char * name, const char * value) : name (name), value (value), text (true) {}
+        Field (const char * name, const std::string & value) : name (name), value (value), text (true) {}
+        Field (const char * name, double value);
+        Field (const char * name, std::uint64_t value) : name (name), value (std::to_string (value)), text (false) {}
+        Field (const char * name, unsigned value) : name (name), value (std::to_string (value)), text (false) {}
+        Field (const char * name, int value) : name (name), value (std::to_string (value)), text (false) {}
+    };
+
+    // Report
+    //  - machine-readable output of measurements
+    //  - csv: header line is written before the first row, and again whenever the set of fields changes
+    //  - json: single array of objects, closed by destructor
+    //
+    class Report {
+        std::FILE * output;
+        bool json;
+        std::vector <std::string> header;
+        std::size_t rows = 0;
+
+    public:
+        Report (const std::string & format, std::FILE * output);
+        ~Report ();
+
+        void Row (const std::vector <Field> & fields);
+    };
+
+    // Numbers
+    //  - parses comma separated list of numbers, returns empty vector on error
+    //
+    std::vector <double> Numbers (const std::string & list);
+
+    // Sweep
+    //  - thread counts 1, 2, 4, ... up to 'threads', always including 'threads' itself
+    //
+    std::vector <unsigned> Sweep (unsigned threads);
+
+    // Cpus
+    //  - CPUs the process is allowed to run on (sched_getaffinity), in ascending order
+    //
+    std::vector <int> Cpus ();
+
+    // Pin
+    //  - restricts 'thread' to single 'cpu', returns false on failure
+    //
+    bool Pin (std::thread & thread, int cpu);
+
+    // Counters
+    //  - per-thread results, padded to avoid false sharing between the threads
+    //
+    struct alignas (64) Counters {
+        std::uint64_t operations = 0;
+    };
+
+    // Run
+    //  - starts 'n' threads calling 'f (index, stop)', pinned according to options
+    //  - all threads are released at once, after 'duration' seconds 'stop' is set and the threads joined
+    //  - returns the actual measured time in seconds
+    //
+    template <typename F>
+    double Run (const Options & options, unsigned n, double duration, F && f) {
+        std::atomic <unsigned> ready { 0 };
+        std::atomic <bool> go { false };
+        std::atomic <bool> stop { false };
+        std::vector <std::thread> threads;
+
+        auto cpus = Cpus ();
+        for (auto i = 0u; i != n; ++i) {
+            threads.emplace_back ([&, i] {
+                ready.fetch_add (1);
+                while (!go.load (std::memory_order_acquire)) {
+                    std::this_thread::yield ();
+                }
+                f (i, stop);
+            });
+            if (options.pin == "compact" && !cpus.empty ()) {
+                Pin (threads.back (), cpus [i % cpus.size ()]);
+            }
+        }
+        while (ready.load () != n) {
+            std::this_thread::yield ();
+        }
+
+        auto t0 = std::chrono::steady_clock::now ();
+        go.store (true, std::memory_order_release);
+
+        std::this_thread::sleep_for (std::chrono::duration <double> (duration));
+        stop.store (true, std::memory_order_relaxed);
+
+        for (auto & thread : threads) {
+            thread.join ();
+        }
+        return std::chrono::duration <double> (std::chrono::steady_clock::now () - t0).count ();
+    }
+
+    // lock adapters
+    //  - uniform interface: lock, unlock, lock_shared, unlock_shared
+    //  - 'name' is what --lock option selects, 'width' is size of the lock state in bits (0 if not applicable),
+    //    'shared' is false for locks without reader mode, those lock exclusively in lock_shared
+
+    template <typename StateType>
+    struct SpinLock {
+        static const char * const name;
+        static constexpr unsigned width = 8 * sizeof (StateType);
+        static constexpr bool shared = true;
+
+        Windows::RwSpinLock <StateType> spin;
+
+        void lock () noexcept { this->spin.AcquireExclusive (); }
+        void unlock () noexcept { this->spin.ReleaseExclusive (); }
+        void lock_shared () noexcept { this->spin.AcquireShared (); }
+        void unlock_shared () noexcept { this->spin.ReleaseShared (); }
+    };
+
+    template <> inline const char * const SpinLock <short>::name = "spin-short";
+    template <> inline const char * const SpinLock <long>::name = "spin-long";
+    template <> inline const char * const SpinLock <long long>::name = "spin-longlong";
+
+    struct Mutex {
+        static constexpr const char * name = "std-mutex";
+        static constexpr unsigned width = 0;
+        static constexpr bool shared = false;
+
+        std::mutex mutex;
+
+        void lock () { this->mutex.lock (); }
+        void unlock () { this->mutex.unlock (); }
+        void lock_shared () { this->mutex.lock (); }
+        void unlock_shared () { this->mutex.unlock (); }
+    };
+
+    struct SharedMutex {
+        static constexpr const char * name = "std-shared-mutex";
+        static constexpr unsigned width = 0;
+        static constexpr bool shared = true;
+
+        std::shared_mutex mutex;
+
+        void lock () { this->mutex.lock (); }
+        void unlock () { this->mutex.unlock (); }
+        void lock_shared () { this->mutex.lock_shared (); }
+        void unlock_shared () { this->mutex.unlock_shared (); }
+    };
+
+    struct PthreadRwLock {
+        static constexpr const char * name = "pthread-rwlock";
+        static constexpr unsigned width = 0;
+        static constexpr bool shared = true;
+
+        pthread_rwlock_t rwlock;
+
+        PthreadRwLock () { pthread_rwlock_init (&this->rwlock, nullptr); }
+        ~PthreadRwLock () { pthread_rwlock_destroy (&this->rwlock); }
+
+        void lock () noexcept { pthread_rwlock_wrlock (&this->rwlock); }
+        void unlock () noexcept { pthread_rwlock_unlock (&this->rwlock); }
+        void lock_shared () noexcept { pthread_rwlock_rdlock (&this->rwlock); }
+        void unlock_shared () noexcept { pthread_rwlock_unlock (&this->rwlock); }
+    };
+
+    struct PthreadSpinLock {
+        static constexpr const char * name = "pthread-spinlock";
+        static constexpr unsigned width = 8 * sizeof (pthread_spinlock_t);
+        static constexpr bool shared = false;
+
+        pthread_spinlock_t spinlock;
+
+        PthreadSpinLock () { pthread_spin_init (&this->spinlock, PTHREAD_PROCESS_PRIVATE); }
+        ~PthreadSpinLock () { pthread_spin_destroy (&this->spinlock); }
+
+        void lock () noexcept { pthread_spin_lock (&this->spinlock); }
+        void unlock () noexcept { pthread_spin_unlock (&this->spinlock); }
+        void lock_shared () noexcept { pthread_spin_lock (&this->spinlock); }
+        void unlock_shared () noexcept { pthread_spin_unlock (&this->spinlock); }
+    };
+
+    // Timed
+    //  - forwards exclusive acquisition to 'inner' lock, passing every wait, in RwSpinLockTimestamp units,
+    //    to 'recorder.Record', e.g. Histogram
+    //
+    template <typename Lock, typename Recorder>
+    struct Timed {
+        Lock & inner;
+        Recorder & recorder;
+
+        void lock () noexcept {
+            auto t0 = Windows::RwSpinLockTimestamp ();
+            this->inner.lock ();
+            this->recorder.Record (Windows::RwSpinLockTimestamp () - t0);
+        }
+        void unlock () noexcept {
+            this->inner.unlock ();
+        }
+    };
+
+    // Type
+    //  - tag passed to ForEachLock callbacks
+    //
+    template <typename Lock>
+    struct Type {
+        using type = Lock;
+    };
+
+    // ForEachSpinLock
+    //  - calls 'f (Type <Lock> ())' for every RwSpinLock variant selected by options, in fixed order,
+    //    for modes measuring features other locks don't have
+    //
+    template <typename F>
+    void ForEachSpinLock (const Options & options, F && f) {
+        auto each = [&] (auto tag) {
+            if (options.Selected (decltype (tag)::type::name)) {
+                f (tag);
+            }
+        };
+        each (Type <SpinLock <short>> ());
+        each (Type <SpinLock <long>> ());
+        each (Type <SpinLock <long long>> ());
+    }
+
+    // ForEachLock
+    //  - calls 'f (Type <Lock> ())' for every lock selected by options, in fixed order, spin locks first
+    //
+    template <typename F>
+    void ForEachLock (const Options & options, F && f) {
+        auto each = [&] (auto tag) {
+            if (options.Selected (decltype (tag)::type::name)) {
+                f (tag);
+            }
+        };
+        ForEachSpinLock (options, f);
+        each (Type <Mutex> ());
+        each (Type <SharedMutex> ());
+        each (Type <PthreadRwLock> ());
+        each (Type <PthreadSpinLock> ());
+    }
+
+    // LockNames
+    //  - comma separated list of all lock names, for usage text
+    //
+    std::string LockNames ();
+
+    // modes
+    //  - each runs measurements selected by options and writes rows into the report
+    //  - return false on invalid options, after printing the reason to stderr
+
+    bool Throughput (const Options & options, Report & report);
+    bool RwSweep (const Options & options, Report & report);
+    bool Latency (const Options & options, Report & report);
+    bool Process (const Options & options, Report & report);
+    bool Oversubscribe (const Options & options, Report & report);
+    bool Fairness (const Options & options, Report & report);
+    bool Upgrade (const Options & options, Report & report);
+    bool FastPath (const Options & options, Report & report);
+    bool CsSweep (const Options & options, Report & report);
+    bool AsyncWait (const Options & options, Report & report);
+}
+
+#endif
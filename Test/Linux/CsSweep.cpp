@@ -0,0 +1,99 @@
+#include "Bench.hpp"
+#include "../../Windows_RwSpinLockStatistics.hpp"
+
+// CsSweep
+//  - sweeps length of the critical section (--inside, ns) against delay between acquisitions (--outside, ns),
+//    all --threads threads acquire the lock exclusively
+//  - both are calibrated busy-work, chain of dependent multiplications without memory accesses or
+//    serializing instructions, so that it behaves as computation on data already in cache
+//  - reports throughput and the fraction of time the lock was held doing the busy-work, rows form
+//    a heat map per lock showing where the "few instructions" guidance stops holding
+//
+namespace {
+    inline std::uint64_t Work (std::uint64_t n, std::uint64_t x) noexcept {
+        for (auto i = 0uLL; i != n; ++i) {
+            x = x * 6364136223846793005uLL + 1442695040888963407uLL;
+            __asm__ __volatile__ ("" : "+r" (x));
+        }
+        return x;
+    }
+
+    // Calibrate
+    //  - iterations of Work per nanosecond, best of several runs
+    //
+    double Calibrate () {
+        const auto frequency = Windows::RwSpinLockTimestampFrequency () / 1e9;
+        const auto n = 1000000uLL;
+
+        std::uint64_t best = ~0uLL;
+        std::uint64_t x = 1;
+        for (auto repetition = 0; repetition != 9; ++repetition) {
+            auto t0 = Windows::RwSpinLockTimestamp ();
+            x = Work (n, x);
+            auto t1 = Windows::RwSpinLockTimestamp ();
+            best = std::min (best, t1 - t0);
+        }
+        return double (n) / (best / frequency);
+    }
+}
+
+bool Bench::CsSweep (const Options & options, Report & report) {
+    auto inside = Numbers (options.inside);
+    auto outside = Numbers (options.outside);
+    if (inside.empty () || outside.empty ()) {
+        std::fprintf (stderr, "invalid --inside or --outside list\n");
+        return false;
+    }
+
+    const auto rate = Calibrate (); // Work iterations per nanosecond
+    const auto threads = options.threads;
+
+    ForEachLock (options, [&] (auto tag) {
+        using Lock = typename decltype (tag)::type;
+
+        for (auto in : inside) {
+            for (auto out : outside) {
+                const auto n_in = std::uint64_t (in * rate);
+                const auto n_out = std::uint64_t (out * rate);
+
+                auto lock = std::make_unique <Lock> ();
+                std::vector <Counters> counters (threads);
+                std::vector <Counters> sinks (threads);
+
+                auto seconds = Run (options, threads, options.duration, [&] (unsigned index, const std::atomic <bool> & stop) {
+                    std::uint64_t operations = 0;
+                    std::uint64_t x = index + 1;
+
+                    while (!stop.load (std::memory_order_relaxed)) {
+                        lock->lock ();
+                        x = Work (n_in, x);
+                        lock->unlock ();
+
+                        x = Work (n_out, x);
+                        ++operations;
+                    }
+                    counters [index].operations = operations;
+                    sinks [index].operations = x;
+                });
+
+                std::uint64_t total = 0;
+                for (const auto & c : counters) {
+                    total += c.operations;
+                }
+
+                report.Row ({
+                    { "mode", "cs-sweep" },
+                    { "lock", Lock::name },
+                    { "width", Lock::width },
+                    { "threads", threads },
+                    { "inside_ns", in },
+                    { "outside_ns", out },
+                    { "seconds", seconds },
+                    { "ops_per_s", total / seconds },
+                    { "lock_busy", total * in / 1e9 / seconds },
+                });
+            }
+        }
+    });
+    return true;
+}
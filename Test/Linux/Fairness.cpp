@@ -0,0 +1,132 @@
+#include "Bench.hpp"
+#include "Workload.hpp"
+#include "Mixed.hpp"
+
+#include <cmath>
+
+// Fairness
+//  - automated version of the README fairness measurement: all --threads threads run the workload,
+//    per-thread acquisition counts are compared
+//  - then --writers of the threads only write and the rest only read (Mixed workload, --work words),
+//    readers and writers are reported separately
+//  - each row reports max/min ratio of per-thread counts (empty, or null in json, if some thread starved),
+//    Jain's fairness index (1.0 - perfectly fair, 1/n - single thread got everything), number of threads
+//    that never acquired the lock, and the longest single wait of any thread, the starvation detector
+//
+namespace {
+    struct alignas (64) Share {
+        std::uint64_t operations = 0;
+        std::uint64_t longest = 0;  // RwSpinLockTimestamp units
+
+        void Record (std::uint64_t wait) noexcept {
+            if (wait > this->longest) {
+                this->longest = wait;
+            }
+        }
+    };
+
+    template <typename Lock>
+    void Summarize (Bench::Report & report, const char * role, unsigned threads,
+                    const Share * shares, std::size_t n, double seconds, double frequency) {
+        std::uint64_t total = 0;
+        std::uint64_t min = ~0uLL;
+        std::uint64_t max = 0;
+        std::uint64_t longest = 0;
+        unsigned starved = 0;
+        unsigned victim = 0;
+        double squares = 0.0;
+
+        for (auto i = 0u; i != n; ++i) {
+            const auto & share = shares [i];
+            total += share.operations;
+            squares += double (share.operations) * double (share.operations);
+            min = std::min (min, share.operations);
+            max = std::max (max, share.operations);
+            if (share.operations == 0) {
+                ++starved;
+            }
+            if (share.longest > longest) {
+                longest = share.longest;
+                victim = i;
+            }
+        }
+
+        report.Row ({
+            { "mode", "fairness" },
+            { "lock", Lock::name },
+            { "width", Lock::width },
+            { "role", role },
+            { "threads", threads },
+            { "role_threads", unsigned (n) },
+            { "seconds", seconds },
+            { "operations", total },
+            { "thread_min", min },
+            { "thread_max", max },
+            { "max_min_ratio", min ? double (max) / min : INFINITY },
+            { "jain_index", squares ? double (total) * double (total) / (n * squares) : 0.0 },
+            { "starved", starved },
+            { "longest_wait_ms", longest / frequency / 1e6 },
+            { "longest_wait_thread", victim },
+        });
+    }
+}
+
+bool Bench::Fairness (const Options & options, Report & report) {
+    if (options.work == 0 || options.writers >= options.threads) {
+        std::fprintf (stderr, "invalid --work, or --writers not less than --threads\n");
+        return false;
+    }
+
+    const auto frequency = Windows::RwSpinLockTimestampFrequency () / 1e9; // units per nanosecond
+    const auto threads = options.threads;
+    const auto writers = options.writers ? options.writers : std::max (1u, threads / 4);
+
+    ForEachLock (options, [&] (auto tag) {
+        using Lock = typename decltype (tag)::type;
+
+        // all threads running the workload
+
+        {
+            auto lock = std::make_unique <Lock> ();
+            auto workload = std::make_unique <Workload> (options.kind, threads);
+            std::vector <Share> shares (threads);
+
+            auto seconds = Run (options, threads, options.duration, [&] (unsigned index, const std::atomic <bool> & stop) {
+                Share share;
+                Timed <Lock, Share> timed { *lock, share };
+                Workload::Thread thread (index);
+
+                while (!stop.load (std::memory_order_relaxed)) {
+                    workload->Step (timed, thread);
+                    ++share.operations;
+                }
+                shares [index] = share;
+            });
+
+            Summarize <Lock> (report, options.workload.c_str (), threads, shares.data (), threads, seconds, frequency);
+        }
+
+        // dedicated writers and readers, writers first
+
+        if (threads >= 2) {
+            auto lock = std::make_unique <Lock> ();
+            std::vector <std::uint64_t> table (options.work);
+            std::vector <Share> shares (threads);
+            std::vector <Counters> checksums (threads);
+
+            auto seconds = Run (options, threads, options.duration, [&] (unsigned index, const std::atomic <bool> & stop) {
+                Share share;
+                checksums [index].operations = Mixed (*lock, table, index < writers ? 0.0 : 100.0, index, stop,
+                                                      [&share] (bool, std::uint64_t wait) {
+                    ++share.operations;
+                    share.Record (wait);
+                });
+                shares [index] = share;
+            });
+
+            Summarize <Lock> (report, "writer", threads, shares.data (), writers, seconds, frequency);
+            Summarize <Lock> (report, "reader", threads, shares.data () + writers, threads - writers, seconds, frequency);
+        }
+    });
+    return true;
+}
@@ -0,0 +1,129 @@
+#include "Bench.hpp"
+#include "../../Windows_RwSpinLockStatistics.hpp"
+
+// FastPath
+//  - uncontended cost of single-thread operations of RwSpinLock <short/long/long long>, where 16-bit
+//    locked instructions may pay length-changing prefix penalty on x86
+//  - every operation is run --iterations times between fenced TSC reads (LFENCE+RDTSC, RDTSCP+LFENCE),
+//    the best of several repetitions is taken, so the cache and branch predictors are warm,
+//    and cost of the empty loop is subtracted
+//  - reports TSC cycles and nanoseconds per operation pair, e.g. acquire and release
+//
+namespace {
+    inline std::uint64_t Begin () noexcept {
+#if defined (_M_IX86) || defined (_M_AMD64)
+        _mm_lfence ();
+        auto t = __rdtsc ();
+        _mm_lfence ();
+        return t;
+#else
+        return Windows::RwSpinLockTimestamp ();
+#endif
+    }
+
+    inline std::uint64_t End () noexcept {
+#if defined (_M_IX86) || defined (_M_AMD64)
+        unsigned int aux;
+        auto t = __rdtscp (&aux);
+        _mm_lfence ();
+        return t;
+#else
+        return Windows::RwSpinLockTimestamp ();
+#endif
+    }
+
+    inline void Barrier () noexcept {
+        __asm__ __volatile__ ("" ::: "memory");
+    }
+
+    template <typename F>
+    double Measure (unsigned iterations, F && f) {
+        std::uint64_t best = ~0uLL;
+        for (auto repetition = 0; repetition != 9; ++repetition) {
+            auto t0 = Begin ();
+            for (auto i = 0u; i != iterations; ++i) {
+                f ();
+            }
+            auto t1 = End ();
+            best = std::min (best, t1 - t0);
+        }
+        return double (best) / iterations;
+    }
+}
+
+bool Bench::FastPath (const Options & options, Report & report) {
+    if (options.iterations == 0) {
+        std::fprintf (stderr, "invalid --iterations\n");
+        return false;
+    }
+
+    const auto frequency = Windows::RwSpinLockTimestampFrequency () / 1e9; // units per nanosecond
+    const auto iterations = options.iterations;
+    const auto baseline = Measure (iterations, [] { Barrier (); });
+
+    ForEachSpinLock (options, [&] (auto tag) {
+        using Lock = typename decltype (tag)::type;
+
+        auto lock = std::make_unique <Lock> ();
+        auto & spin = lock->spin;
+
+        auto row = [&] (const char * operation, double units) {
+            units = std::max (0.0, units - baseline);
+            report.Row ({
+                { "mode", "fastpath" },
+                { "lock", Lock::name },
+                { "width", Lock::width },
+                { "operation", operation },
+                { "iterations", iterations },
+                { "cycles_per_op", units },
+                { "ns_per_op", units / frequency },
+            });
+        };
+
+        row ("try-exclusive", Measure (iterations, [&spin] {
+            if (spin.TryAcquireExclusive ()) {
+                spin.ReleaseExclusive ();
+            }
+        }));
+        row ("try-shared", Measure (iterations, [&spin] {
+            if (spin.TryAcquireShared ()) {
+                spin.ReleaseShared ();
+            }
+        }));
+        row ("exclusive", Measure (iterations, [&spin] {
+            spin.AcquireExclusive ();
+            spin.ReleaseExclusive ();
+        }));
+        row ("shared", Measure (iterations, [&spin] {
+            spin.AcquireShared ();
+            spin.ReleaseShared ();
+        }));
+        row ("guard-exclusive", Measure (iterations, [&spin] {
+            if (auto guard = spin.exclusively ()) {
+                Barrier ();
+            }
+        }));
+        row ("guard-shared", Measure (iterations, [&spin] {
+            if (auto guard = spin.share ()) {
+                Barrier ();
+            }
+        }));
+
+        spin.AcquireShared ();
+        row ("upgrade-downgrade", Measure (iterations, [&spin] {
+            if (spin.TryUpgradeToExclusive ()) {
+                spin.DowngradeToShared ();
+            }
+        }));
+        spin.ReleaseShared ();
+
+        if (auto guard = spin.share ()) {
+            row ("guard-upgrade", Measure (iterations, [&guard] {
+                if (auto upgraded = guard.upgrade ()) {
+                    Barrier ();
+                }
+            }));
+        }
+    });
+    return true;
+}
@@ -0,0 +1,247 @@
+#include <Windows.h>
+#include "../../Windows_RwSpinLock.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <ucontext.h>
+
+// Fibers
+//  - reference round-robin scheduler of ucontext fibers on a single OS thread, the Linux counterpart
+//    of the Win32 fibers scheduler in README, installed as RwSpinLockYieldHook
+//  - tests that waiting fiber hands the OS thread over to the fiber holding the lock, through the hook,
+//    instead of blocking it in SwitchToThread or Sleep
+//  - exits with non-zero code on failure, run by ctest
+
+namespace {
+
+    // Scheduler
+    //  - 'ready' is ring buffer of fibers ready to run, all switches go through the scheduler's own context
+    //  - the hook requeues the waiting fiber at the tail and runs the head, without any allocation,
+    //    only when no other fiber is ready it blocks the thread, counted in 'blocked'
+    //
+    class Scheduler {
+    public:
+        static constexpr std::size_t Capacity = 8;
+
+        struct Fiber {
+            ucontext_t context;
+            void (*entry) (Scheduler &, void *);
+            void * argument;
+            bool done;
+            char stack [65536];
+        };
+
+        unsigned hooked = 0;    // hook calls
+        unsigned blocked = 0;   // hook calls that found no other fiber to run
+
+        // Spawn
+        //  - adds new fiber, 'fiber' must outlive Run
+        //
+        void Spawn (Fiber & fiber, void (*entry) (Scheduler &, void *), void * argument) noexcept {
+            getcontext (&fiber.context);
+            fiber.context.uc_stack.ss_sp = fiber.stack;
+            fiber.context.uc_stack.ss_size = sizeof fiber.stack;
+            fiber.context.uc_link = &this->main;
+            fiber.entry = entry;
+            fiber.argument = argument;
+            fiber.done = false;
+            makecontext (&fiber.context, &Scheduler::Start, 0);
+            this->Push (&fiber);
+        }
+
+        // Run
+        //  - runs ready fibers until all of them finish, with the hook installed for the calling thread
+        //
+        void Run () noexcept {
+            running = this;
+            Windows::RwSpinLockYieldHook::Set (&Scheduler::Hook, this);
+            while (this->count) {
+                this->current = this->Pop ();
+                swapcontext (&this->main, &this->current->context);
+                if (!this->current->done) {
+                    this->Push (this->current);
+                }
+            }
+            this->current = nullptr;
+            Windows::RwSpinLockYieldHook::Set (nullptr);
+            running = nullptr;
+        }
+
+        // Yield
+        //  - switches to the next ready fiber, the calling one stays ready
+        //
+        void Yield () noexcept {
+            swapcontext (&this->current->context, &this->main);
+        }
+
+        static void Hook (void * context, Windows::RwSpinLockPhase phase) noexcept {
+            auto scheduler = static_cast <Scheduler *> (context);
+            ++scheduler->hooked;
+            if (scheduler->count) {
+                scheduler->Yield ();
+            } else {
+                ++scheduler->blocked;
+                Sleep (phase == Windows::RwSpinLockPhase::Sleep0 ? 0 : 1); // nothing else to run
+            }
+        }
+
+    private:
+        ucontext_t main;
+        Fiber * current = nullptr;
+        Fiber * ready [Capacity] = {};
+        std::size_t head = 0;
+        std::size_t count = 0;
+
+        static inline thread_local Scheduler * running = nullptr;
+
+        void Push (Fiber * fiber) noexcept {
+            this->ready [(this->head + this->count++) % Capacity] = fiber;
+        }
+        Fiber * Pop () noexcept {
+            auto fiber = this->ready [this->head];
+            this->head = (this->head + 1) % Capacity;
+            --this->count;
+            return fiber;
+        }
+
+        // Start
+        //  - makecontext passes only int arguments, the fiber is found through the running scheduler
+        //
+        static void Start () noexcept {
+            auto scheduler = running;
+            auto fiber = scheduler->current;
+            fiber->entry (*scheduler, fiber->argument);
+            fiber->done = true;
+        }
+    };
+
+    int failures = 0;
+
+    void Check (bool condition, const char * what) {
+        std::printf ("%s: %s\n", condition ? "ok" : "FAILED", what);
+        if (!condition) {
+            ++failures;
+        }
+    }
+
+    // Handover
+    //  - fiber A holds the lock across a yield, fiber B on the same OS thread waits for it
+    //
+    struct Handover {
+        Windows::RwSpinLock <short> lock;
+        char trace [8] = {};
+        std::size_t n = 0;
+
+        static void A (Scheduler & scheduler, void * argument) {
+            auto test = static_cast <Handover *> (argument);
+            test->lock.AcquireExclusive ();
+            test->trace [test->n++] = 'a';
+            scheduler.Yield ();
+            test->trace [test->n++] = 'A';
+            test->lock.ReleaseExclusive ();
+        }
+        static void B (Scheduler &, void * argument) {
+            auto test = static_cast <Handover *> (argument);
+            test->lock.AcquireExclusive ();
+            test->trace [test->n++] = 'b';
+            test->lock.ReleaseExclusive ();
+        }
+    };
+
+    // PingPong
+    //  - two writers and a reader take turns, each yields inside the critical section
+    //
+    struct PingPong {
+        static constexpr unsigned Iterations = 1000;
+
+        Windows::RwSpinLock <short> lock;
+        unsigned value = 0;
+        unsigned torn = 0;
+
+        static void Writer (Scheduler & scheduler, void * argument) {
+            auto test = static_cast <PingPong *> (argument);
+            for (auto i = 0u; i != Iterations; ++i) {
+                test->lock.AcquireExclusive ();
+                auto v = test->value;
+                scheduler.Yield ();
+                test->value = v + 1;
+                test->lock.ReleaseExclusive ();
+            }
+        }
+        static void Reader (Scheduler & scheduler, void * argument) {
+            auto test = static_cast <PingPong *> (argument);
+            for (auto i = 0u; i != Iterations; ++i) {
+                test->lock.AcquireShared ();
+                auto v = test->value;
+                scheduler.Yield ();
+                if (test->value != v) {
+                    ++test->torn;
+                }
+                test->lock.ReleaseShared ();
+            }
+        }
+    };
+
+    // Timeout
+    //  - fiber A holds the lock until B gives up, B's timed acquisition must time out without blocking
+    //
+    struct Timeout {
+        Windows::RwSpinLock <short> lock;
+        bool acquired = true;
+        bool finished = false;
+
+        static void A (Scheduler & scheduler, void * argument) {
+            auto test = static_cast <Timeout *> (argument);
+            test->lock.AcquireExclusive ();
+            while (!test->finished) {
+                scheduler.Yield ();
+            }
+            test->lock.ReleaseExclusive ();
+        }
+        static void B (Scheduler &, void * argument) {
+            auto test = static_cast <Timeout *> (argument);
+            test->acquired = test->lock.AcquireExclusive (std::uint64_t (20));
+            test->finished = true;
+        }
+    };
+}
+
+int main () {
+    static Scheduler::Fiber fibers [3];
+
+    {
+        Scheduler scheduler;
+        Handover test;
+        scheduler.Spawn (fibers [0], &Handover::A, &test);
+        scheduler.Spawn (fibers [1], &Handover::B, &test);
+        scheduler.Run ();
+
+        Check (std::strcmp (test.trace, "aAb") == 0, "waiting fiber lets the holder release the lock");
+        Check (scheduler.hooked != 0, "waiting fiber yields through the hook");
+        Check (scheduler.blocked == 0, "OS thread is never blocked");
+        Check (!test.lock.IsLocked (), "lock is released");
+    }
+    {
+        Scheduler scheduler;
+        PingPong test;
+        scheduler.Spawn (fibers [0], &PingPong::Writer, &test);
+        scheduler.Spawn (fibers [1], &PingPong::Reader, &test);
+        scheduler.Spawn (fibers [2], &PingPong::Writer, &test);
+        scheduler.Run ();
+
+        Check (test.value == 2 * PingPong::Iterations, "writers yielding under the lock don't lose updates");
+        Check (test.torn == 0, "reader yielding under the lock sees no writes");
+        Check (scheduler.blocked == 0, "OS thread is never blocked");
+    }
+    {
+        Scheduler scheduler;
+        Timeout test;
+        scheduler.Spawn (fibers [0], &Timeout::A, &test);
+        scheduler.Spawn (fibers [1], &Timeout::B, &test);
+        scheduler.Run ();
+
+        Check (!test.acquired, "timed acquisition times out while the holder keeps running");
+        Check (scheduler.blocked == 0, "OS thread is never blocked");
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,124 @@
+#ifndef BENCH_HISTOGRAM_HPP
+#define BENCH_HISTOGRAM_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+namespace Bench {
+
+    // Histogram
+    //  - HDR-style histogram of 64-bit values: exact below 2^Bits, above that every power of two is split
+    //    into 2^(Bits-1) linear sub-buckets, so the relative error stays below 2^-(Bits-1) over whole range
+    //  - fixed size (7424 counters, 58 kB) held inline, recording is constant time and never allocates,
+    //    and the histogram can be placed into memory shared with other processes
+    //  - not thread-safe, use one per thread and Merge them afterwards
+    //
+    class Histogram {
+        static constexpr unsigned Bits = 8;
+        static constexpr unsigned Half = 1u << (Bits - 1);
+        static constexpr std::size_t Size = ((64 - Bits) << (Bits - 1)) + (1u << Bits);
+
+        std::array <std::uint64_t, Size> counts = {};
+        std::uint64_t total = 0;
+        std::uint64_t maximum = 0;
+        double sum = 0.0;
+
+        static std::size_t Index (std::uint64_t value) noexcept {
+            if (value < (1u << Bits))
+                return std::size_t (value);
+
+            auto e = unsigned (63 - __builtin_clzll (value)) - (Bits - 1);
+            return (std::size_t (e) << (Bits - 1)) + std::size_t (value >> e);
+        }
+        static std::uint64_t Lowest (std::size_t index) noexcept {
+            if (index < (1u << Bits))
+                return index;
+
+            auto e = unsigned (index >> (Bits - 1)) - 1;
+            auto m = std::uint64_t ((index & (Half - 1)) | Half);
+            return m << e;
+        }
+        static std::uint64_t Highest (std::size_t index) noexcept {
+            return Lowest (index + 1) - 1;
+        }
+
+    public:
+        void Record (std::uint64_t value) noexcept {
+            ++this->counts [Index (value)];
+            ++this->total;
+            this->sum += double (value);
+            if (value > this->maximum) {
+                this->maximum = value;
+            }
+        }
+
+        void Merge (const Histogram & other) {
+            for (auto i = 0u; i != Size; ++i) {
+                this->counts [i] += other.counts [i];
+            }
+            this->total += other.total;
+            this->sum += other.sum;
+            if (other.maximum > this->maximum) {
+                this->maximum = other.maximum;
+            }
+        }
+
+        std::uint64_t Count () const noexcept { return this->total; }
+        std::uint64_t Max () const noexcept { return this->maximum; }
+        double Mean () const noexcept { return this->total ? this->sum / this->total : 0.0; }
+
+        // Percentile
+        //  - highest value equivalent (within the bucket precision) to the value at 'percent' (0..100)
+        //  - returns 0 for empty histogram
+        //
+        std::uint64_t Percentile (double percent) const noexcept {
+            if (this->total == 0)
+                return 0;
+
+            auto target = std::uint64_t (std::ceil (percent / 100.0 * this->total));
+            if (target == 0) {
+                target = 1;
+            }
+
+            std::uint64_t seen = 0;
+            for (auto i = 0u; i != Size; ++i) {
+                seen += this->counts [i];
+                if (seen >= target)
+                    return std::min (Highest (i), this->maximum);
+            }
+            return this->maximum;
+        }
+
+        // Write
+        //  - percentile distribution in HdrHistogram's text (.hgrm) format, readable by its plotting tools
+        //  - values are divided by 'scale', e.g. timestamp units per nanosecond
+        //
+        void Write (std::FILE * output, double scale) const {
+            std::fprintf (output, "%12s %14s %10s %14s\n\n", "Value", "Percentile", "TotalCount", "1/(1-Percentile)");
+
+            std::uint64_t seen = 0;
+            for (auto i = 0u; i != Size; ++i) {
+                if (this->counts [i]) {
+                    seen += this->counts [i];
+
+                    auto value = std::min (Highest (i), this->maximum) / scale;
+                    auto fraction = double (seen) / this->total;
+                    if (seen != this->total) {
+                        std::fprintf (output, "%12.3f %2.12f %10llu %14.2f\n",
+                                      value, fraction, (unsigned long long) seen, 1.0 / (1.0 - fraction));
+                    } else {
+                        std::fprintf (output, "%12.3f %2.12f %10llu\n",
+                                      value, fraction, (unsigned long long) seen);
+                    }
+                }
+            }
+            std::fprintf (output, "#[Mean    = %12.3f, Max            = %12.3f]\n", this->Mean () / scale, this->maximum / scale);
+            std::fprintf (output, "#[Total count = %10llu, SubBuckets = %u]\n", (unsigned long long) this->total, Half * 2);
+        }
+    };
+}
+
+#endif
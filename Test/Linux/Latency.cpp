@@ -0,0 +1,102 @@
+#include "Bench.hpp"
+#include "Mixed.hpp"
+#include "Histogram.hpp"
+
+// Latency
+//  - distribution of per-acquisition wait, recorded into per-thread Histograms with RwSpinLockTimestamp
+//  - runs the Mixed workload of rw-sweep with --threads threads, for every --reads percentage
+//  - reports one row per lock, read percentage and acquisition mode (shared/exclusive) with
+//    mean, p50, p90, p99, p99.9 and max in nanoseconds
+//  - with --histograms <directory> also writes the full distributions as .hgrm files for plotting
+//
+namespace {
+    struct Recorder {
+        Bench::Histogram shared;
+        Bench::Histogram exclusive;
+    };
+
+    bool Save (const std::string & directory, const char * lock, unsigned threads, double percent, const char * acquire,
+               const Bench::Histogram & histogram, double frequency) {
+        char name [256];
+        std::snprintf (name, sizeof name, "%s/%s-%ut-%gr-%s.hgrm", directory.c_str (), lock, threads, percent, acquire);
+
+        if (auto file = std::fopen (name, "w")) {
+            histogram.Write (file, frequency);
+            std::fclose (file);
+            return true;
+        } else {
+            std::fprintf (stderr, "failed to write %s\n", name);
+            return false;
+        }
+    }
+}
+
+bool Bench::Latency (const Options & options, Report & report) {
+    auto reads = Numbers (options.reads);
+    if (reads.empty () || options.work == 0) {
+        std::fprintf (stderr, "invalid --reads list or --work\n");
+        return false;
+    }
+
+    const auto frequency = Windows::RwSpinLockTimestampFrequency () / 1e9; // units per nanosecond
+    const auto threads = options.threads;
+
+    ForEachLock (options, [&] (auto tag) {
+        using Lock = typename decltype (tag)::type;
+
+        for (auto percent : reads) {
+            auto lock = std::make_unique <Lock> ();
+            std::vector <std::uint64_t> table (options.work);
+            std::vector <Recorder> recorders (threads);
+            std::vector <Counters> checksums (threads);
+
+            auto seconds = Run (options, threads, options.duration, [&] (unsigned index, const std::atomic <bool> & stop) {
+                auto & recorder = recorders [index];
+                checksums [index].operations = Mixed (*lock, table, percent, index, stop, [&recorder] (bool shared, std::uint64_t wait) {
+                    if (shared) {
+                        recorder.shared.Record (wait);
+                    } else {
+                        recorder.exclusive.Record (wait);
+                    }
+                });
+            });
+
+            Recorder total;
+            for (const auto & recorder : recorders) {
+                total.shared.Merge (recorder.shared);
+                total.exclusive.Merge (recorder.exclusive);
+            }
+
+            for (auto shared : { true, false }) {
+                const auto & histogram = shared ? total.shared : total.exclusive;
+                const auto acquire = shared ? "shared" : "exclusive";
+
+                if (histogram.Count () == 0)
+                    continue;
+
+                report.Row ({
+                    { "mode", "latency" },
+                    { "lock", Lock::name },
+                    { "width", Lock::width },
+                    { "shared", Lock::shared ? "yes" : "no" },
+                    { "threads", threads },
+                    { "read_pct", percent },
+                    { "acquire", acquire },
+                    { "seconds", seconds },
+                    { "count", histogram.Count () },
+                    { "mean_ns", histogram.Mean () / frequency },
+                    { "p50_ns", histogram.Percentile (50.0) / frequency },
+                    { "p90_ns", histogram.Percentile (90.0) / frequency },
+                    { "p99_ns", histogram.Percentile (99.0) / frequency },
+                    { "p999_ns", histogram.Percentile (99.9) / frequency },
+                    { "max_ns", histogram.Max () / frequency },
+                });
+
+                if (!options.histograms.empty ()) {
+                    Save (options.histograms, Lock::name, threads, percent, acquire, histogram, frequency);
+                }
+            }
+        }
+    });
+    return true;
+}
@@ -0,0 +1,78 @@
+#include "Bench.hpp"
+#include <cstring>
+
+// LockBench
+//  - Linux benchmark driver comparing RwSpinLock <short/long/long long> against std::mutex, std::shared_mutex,
+//    pthread_rwlock_t and pthread_spinlock_t; the portable counterpart of BmAllocTest
+//  - results are written to stdout as CSV or JSON, one row per measurement
+//  - command-line: "LockBench [--mode m] [--lock l,...] [--workload w] [--threads n] [--duration s] [--pin p] [--format f]"
+
+namespace {
+    struct Mode {
+        const char * name;
+        bool (*run) (const Bench::Options &, Bench::Report &);
+        const char * description;
+    };
+
+    const Mode modes [] = {
+        { "throughput", &Bench::Throughput, "operations per second of all threads running the workload" },
+        { "rw-sweep", &Bench::RwSweep, "read percentage (--reads) against thread count, throughput and wait per mode" },
+        { "latency", &Bench::Latency, "percentiles of acquisition wait per mode, for each read percentage (--reads)" },
+        { "process", &Bench::Process, "--threads forked processes over shared memory, spin locks against\n"
+                                      "                       pthread-rwlock-pshared and pthread-mutex-robust" },
+        { "oversubscribe", &Bench::Oversubscribe, "--factors threads per core while confined to --cores CPUs, with spin escalation" },
+        { "fairness", &Bench::Fairness, "per-thread share of acquisitions, max/min ratio, Jain index and longest wait" },
+        { "upgrade", &Bench::Upgrade, "README insert-via-upgrade loop against reader count, spin locks only" },
+        { "fastpath", &Bench::FastPath, "uncontended single-thread cycles per operation, spin locks only" },
+        { "cs-sweep", &Bench::CsSweep, "critical section length (--inside) against delay between acquisitions (--outside)" },
+        { "async", &Bench::AsyncWait, "latency of async_exclusively/async_share against blocking acquisition, spin locks only" },
+    };
+
+    void usage () {
+        std::fprintf (stderr,
+                      "usage: LockBench [options]\n"
+                      "  --mode <name>        benchmark mode, default throughput\n"
+                      "  --lock <names>       comma separated list of locks, default all\n"
+                      "  --workload <name>    bmalloc (default) or counter\n"
+                      "  --threads <n>        number of threads, default number of allowed CPUs\n"
+                      "  --duration <s>       seconds per measurement, default 2\n"
+                      "  --pin <compact|none> pin thread i to i-th allowed CPU (default), or not at all\n"
+                      "  --format <csv|json>  output format, default csv\n"
+                      "  --reads <list>       rw-sweep, latency, async: percentages of shared acquisitions, default 0,50,90,99,100\n"
+                      "  --work <n>           rw-sweep, latency, async: words read or written under the lock, default 64\n"
+                      "  --histograms <dir>   latency: write full distributions into <dir> as HdrHistogram .hgrm files\n"
+                      "  --factors <list>     oversubscribe: threads per core, default 1,2,4,8\n"
+                      "  --cores <list>       oversubscribe: numbers of CPUs to confine to, default all, half and one\n"
+                      "  --writers <n>        fairness, upgrade: threads that only write/insert, the rest only read, default quarter\n"
+                      "  --iterations <n>     fastpath: operations per timed loop, default 1000000\n"
+                      "  --inside <list>      cs-sweep: critical section lengths in ns, default 0,10,30,100,300,1000,3000,10000\n"
+                      "  --outside <list>     cs-sweep: delays between acquisitions in ns, default 0,100,1000,10000\n"
+                      "\nmodes:\n");
+        for (const auto & mode : modes) {
+            std::fprintf (stderr, "  %-20s %s\n", mode.name, mode.description);
+        }
+        std::fprintf (stderr, "\nlocks: %s\n", Bench::LockNames ().c_str ());
+    }
+}
+
+int main (int argc, char ** argv) {
+    Bench::Options options;
+    std::string error;
+
+    if (!options.Parse (argc, argv, error)) {
+        std::fprintf (stderr, "%s\n\n", error.c_str ());
+        usage ();
+        return 1;
+    }
+
+    for (const auto & mode : modes) {
+        if (options.mode == mode.name) {
+            Bench::Report report (options.format, stdout);
+            return mode.run (options, report) ? 0 : 1;
+        }
+    }
+
+    std::fprintf (stderr, "unknown mode: %s\n\n", options.mode.c_str ());
+    usage ();
+    return 1;
+}
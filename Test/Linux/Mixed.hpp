@@ -0,0 +1,56 @@
+#ifndef BENCH_MIXED_HPP
+#define BENCH_MIXED_HPP
+
+#include "Bench.hpp"
+#include "../../Windows_RwSpinLockStatistics.hpp"
+
+namespace Bench {
+
+    // Mixed
+    //  - loop of shared and exclusive acquisitions of 'lock' until 'stop' is set, 'percent' of them shared
+    //  - readers sum the words of 'table' under shared lock, writers increment them under exclusive lock,
+    //    so both hold the lock for comparable time
+    //  - 'f (shared, wait)' is called after every operation, outside of the lock, with the time spent
+    //    acquiring the lock in RwSpinLockTimestamp units
+    //  - returns checksum of the reads, so that they can't be optimized away
+    //
+    template <typename Lock, typename F>
+    std::uint64_t Mixed (Lock & lock, std::vector <std::uint64_t> & table, double percent, unsigned index, const std::atomic <bool> & stop, F && f) {
+        const auto threshold = std::uint32_t (percent / 100.0 * 4294967295.0);
+        std::uint32_t random = 2463534242u + 0x9E3779B9u * index;
+        std::uint64_t checksum = 0;
+
+        while (!stop.load (std::memory_order_relaxed)) {
+            random ^= random << 13;
+            random ^= random >> 17;
+            random ^= random << 5;
+
+            auto t0 = Windows::RwSpinLockTimestamp ();
+            if (random < threshold || percent >= 100.0) {
+                lock.lock_shared ();
+                auto wait = Windows::RwSpinLockTimestamp () - t0;
+
+                std::uint64_t sum = 0;
+                for (auto word : table) {
+                    sum += word;
+                }
+                lock.unlock_shared ();
+
+                checksum += sum;
+                f (true, wait);
+            } else {
+                lock.lock ();
+                auto wait = Windows::RwSpinLockTimestamp () - t0;
+
+                for (auto & word : table) {
+                    word = word + 1;
+                }
+                lock.unlock ();
+                f (false, wait);
+            }
+        }
+        return checksum;
+    }
+}
+
+#endif
@@ -0,0 +1,162 @@
+#include "Bench.hpp"
+#include "Workload.hpp"
+
+// Oversubscribe
+//  - runs the workload with --factors times more threads than cores, while the process is confined
+//    (sched_setaffinity) to each of --cores first allowed CPUs, so that lock holders get preempted
+//  - for spin locks also reports where the waiting went, per operation, from RwSpinLockWaitProfile:
+//    rounds of YieldProcessor, SwitchToThread, Sleep (0), Sleep (1) and parking, and time spent waiting
+//  - CPU quotas (cgroup cpu.max) can't be set from within, run the whole benchmark under e.g.
+//    "systemd-run --scope -p CPUQuota=200%" or "docker run --cpus 2" for those
+//
+namespace {
+    struct alignas (64) Escalation {
+        std::uint64_t operations = 0;
+        std::uint64_t count [5] = {};
+        std::uint64_t elapsed = 0;  // ns
+
+        void Add (const Windows::RwSpinLockWaitProfile & profile) noexcept {
+            for (auto i = 0; i != 5; ++i) {
+                this->count [i] += profile.count [i];
+            }
+            this->elapsed += profile.Elapsed ();
+        }
+    };
+
+    // Profiled
+    //  - forwards exclusive acquisition to 'inner', for spin locks through WaitProfile overload
+    //
+    template <typename Lock>
+    struct Profiled {
+        Lock & inner;
+        Escalation & escalation;
+
+        void lock () { this->inner.lock (); }
+        void unlock () { this->inner.unlock (); }
+    };
+
+    template <typename StateType>
+    struct Profiled <Bench::SpinLock <StateType>> {
+        Bench::SpinLock <StateType> & inner;
+        Escalation & escalation;
+
+        void lock () noexcept {
+            Windows::RwSpinLockWaitProfile profile;
+            this->inner.spin.AcquireExclusive (profile);
+            this->escalation.Add (profile);
+        }
+        void unlock () noexcept { this->inner.spin.ReleaseExclusive (); }
+    };
+
+    // Confine
+    //  - restricts the calling thread, and thus all threads it starts, to 'cpus', restores original set on destruction
+    //
+    class Confine {
+        cpu_set_t original;
+
+    public:
+        explicit Confine (const std::vector <int> & cpus) {
+            sched_getaffinity (0, sizeof this->original, &this->original);
+
+            cpu_set_t set;
+            CPU_ZERO (&set);
+            for (auto cpu : cpus) {
+                CPU_SET (cpu, &set);
+            }
+            sched_setaffinity (0, sizeof set, &set);
+        }
+        ~Confine () {
+            sched_setaffinity (0, sizeof this->original, &this->original);
+        }
+    };
+}
+
+bool Bench::Oversubscribe (const Options & options, Report & report) {
+    auto factors = Numbers (options.factors);
+    auto allowed = Cpus ();
+    if (factors.empty () || allowed.empty ()) {
+        std::fprintf (stderr, "invalid --factors list or no allowed CPUs\n");
+        return false;
+    }
+
+    std::vector <unsigned> cores;
+    if (options.cores.empty ()) {
+        cores = { unsigned (allowed.size ()), unsigned (allowed.size () / 2), 1u };
+    } else {
+        for (auto n : Numbers (options.cores)) {
+            cores.push_back (unsigned (n));
+        }
+    }
+    cores.erase (std::remove_if (cores.begin (), cores.end (),
+                                 [&allowed] (unsigned n) { return n == 0 || n > allowed.size (); }), cores.end ());
+    cores.erase (std::unique (cores.begin (), cores.end ()), cores.end ());
+    if (cores.empty ()) {
+        std::fprintf (stderr, "invalid --cores list, %zu CPUs allowed\n", allowed.size ());
+        return false;
+    }
+
+    ForEachLock (options, [&] (auto tag) {
+        using Lock = typename decltype (tag)::type;
+
+        for (auto n : cores) {
+            for (auto factor : factors) {
+                auto threads = std::max (1u, unsigned (factor * n));
+
+                Confine confine (std::vector <int> (allowed.begin (), allowed.begin () + n));
+                auto lock = std::make_unique <Lock> ();
+                auto workload = std::make_unique <Workload> (options.kind, threads);
+                std::vector <Escalation> results (threads);
+
+                auto seconds = Run (options, threads, options.duration, [&] (unsigned index, const std::atomic <bool> & stop) {
+                    Escalation escalation;
+                    Profiled <Lock> profiled { *lock, escalation };
+                    Workload::Thread thread (index);
+
+                    while (!stop.load (std::memory_order_relaxed)) {
+                        workload->Step (profiled, thread);
+                        ++escalation.operations;
+                    }
+                    results [index] = escalation;
+                });
+
+                Escalation total;
+                std::uint64_t min = ~0uLL;
+                std::uint64_t max = 0;
+                for (const auto & r : results) {
+                    total.operations += r.operations;
+                    for (auto i = 0; i != 5; ++i) {
+                        total.count [i] += r.count [i];
+                    }
+                    total.elapsed += r.elapsed;
+                    min = std::min (min, r.operations);
+                    max = std::max (max, r.operations);
+                }
+
+                auto per = [&total] (double value) {
+                    return total.operations ? value / total.operations : 0.0;
+                };
+
+                report.Row ({
+                    { "mode", "oversubscribe" },
+                    { "lock", Lock::name },
+                    { "width", Lock::width },
+                    { "workload", options.workload },
+                    { "cores", n },
+                    { "factor", factor },
+                    { "threads", threads },
+                    { "seconds", seconds },
+                    { "ops_per_s", total.operations / seconds },
+                    { "thread_min", min },
+                    { "thread_max", max },
+                    { "pause_per_op", per (total.count [0]) },
+                    { "yield_per_op", per (total.count [1]) },
+                    { "sleep0_per_op", per (total.count [2]) },
+                    { "sleep1_per_op", per (total.count [3]) },
+                    { "park_per_op", per (total.count [4]) },
+                    { "wait_ns_per_op", per (total.elapsed) },
+                });
+            }
+        }
+    });
+    return true;
+}
@@ -0,0 +1,97 @@
+#include <Windows.h>
+#include "../../Windows_RwSpinLockPerCpu.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+// PerCpu
+//  - test of RwSpinLockPerCpu: readers on all processors against writers, and the writer's wait for readers
+//    to drain, which must report rounds spent also when it times out
+//  - exits with non-zero code on failure, run by ctest
+//
+namespace {
+    int failures = 0;
+
+    void Check (bool condition, const char * what) {
+        std::printf ("%s: %s\n", condition ? "ok" : "FAILED", what);
+        if (!condition) {
+            ++failures;
+        }
+    }
+}
+
+int main () {
+
+    // writer times out draining a reader, rounds are reported
+
+    {
+        Windows::RwSpinLockPerCpu <> lock;
+        std::atomic <bool> entered { false };
+        std::atomic <bool> leave { false };
+
+        std::thread reader ([&] {
+            auto guard = lock.share ();
+            entered = true;
+            while (!leave) {
+                Sleep (1);
+            }
+        });
+        while (!entered) {
+            Sleep (1);
+        }
+
+        std::uint32_t rounds = 0;
+        Check (!lock.AcquireExclusive (std::uint64_t (50), &rounds), "writer times out while reader holds the lock");
+        Check (rounds != 0, "timed out drain reports rounds");
+        Check (lock.IsLocked () && !lock.IsLockedExclusively (), "reader still holds the lock");
+
+        leave = true;
+        reader.join ();
+
+        rounds = 0;
+        Check (lock.AcquireExclusive (std::uint64_t (1000), &rounds), "writer acquires after the reader leaves");
+        Check (lock.IsLockedExclusively (), "lock is held exclusively");
+        lock.ReleaseExclusive ();
+        Check (!lock.IsLocked (), "lock is released");
+    }
+
+    // readers and writers on all processors
+
+    {
+        static constexpr unsigned Iterations = 20000;
+
+        Windows::RwSpinLockPerCpu <> lock;
+        unsigned long long a = 0;
+        unsigned long long b = 0;
+        std::atomic <unsigned> torn { 0 };
+        std::vector <std::thread> threads;
+
+        const auto n = std::max (4u, std::thread::hardware_concurrency ());
+        for (auto i = 0u; i != n; ++i) {
+            threads.emplace_back ([&, i] {
+                for (auto k = 0u; k != Iterations; ++k) {
+                    if ((k + i) % 16 == 0) {
+                        auto guard = lock.exclusively ();
+                        ++a;
+                        ++b;
+                    } else {
+                        auto guard = lock.share ();
+                        if (a != b) {
+                            ++torn;
+                        }
+                    }
+                }
+            });
+        }
+        for (auto & thread : threads) {
+            thread.join ();
+        }
+
+        Check (torn == 0, "readers never see writer's update in progress");
+        Check (a == n * Iterations / 16 && a == b, "no update is lost");
+        Check (!lock.IsLocked (), "lock is released");
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,186 @@
+#include <Windows.h>
+#include "../../Windows_RwSpinLockStatistics.hpp"
+#include "../../Windows_RwSpinLockTiming.hpp"
+#include "../../Windows_RwSpinLockProfiler.hpp"
+#include "../../Windows_RwSpinLockTrace.hpp"
+#include "../../Windows_RwSpinLockSampler.hpp"
+#include "../../Windows_RwSpinLockMonitor.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+
+// Policies
+//  - instantiates RwSpinLock with every instrumentation policy the Linux shim can compile, and checks what
+//    each one recorded of the same sequence: uncontended exclusive and shared scope, and one exclusive
+//    acquisition waiting about 20 ms for the lock to be released by other thread
+//  - ETW and watchdog policies need Win32 APIs the shim doesn't have, see Test/Policies.cpp
+//  - exits with non-zero code on failure, run by ctest
+//
+namespace {
+    int failures = 0;
+
+    void Check (bool condition, const char * what) {
+        std::printf ("%s: %s\n", condition ? "ok" : "FAILED", what);
+        if (!condition) {
+            ++failures;
+        }
+    }
+
+    // Exercise
+    //  - the sequence above, the contended acquisition is made in other thread through scope function
+    //
+    template <typename Policy>
+    void Exercise (Windows::RwSpinLock <long, Policy> & lock) {
+        {
+            auto guard = lock.exclusively ();
+            Check (guard && lock.IsLockedExclusively (), "exclusive scope holds the lock");
+        }
+        {
+            auto guard = lock.share ();
+            Check (guard && lock.IsLocked () && !lock.IsLockedExclusively (), "shared scope holds the lock");
+        }
+
+        lock.AcquireExclusive ();
+        std::thread waiter ([&lock] {
+            auto guard = lock.exclusively ();
+        });
+        Sleep (20);
+        lock.ReleaseExclusive ();
+        waiter.join ();
+
+        Check (!lock.IsLocked (), "lock is released");
+    }
+}
+
+int main () {
+    const auto frequency = Windows::RwSpinLockTimestampFrequency ();
+
+    // Statistics
+
+    {
+        using Policy = Windows::RwSpinLockStatistics <>;
+        Windows::RwSpinLock <long, Policy> lock;
+        Exercise (lock);
+
+        auto counters = Policy::Find (&lock);
+        Check (counters.lock == &lock, "Statistics: lock is reported");
+        Check (counters.acquired [(int) Windows::RwSpinLockMode::Exclusive] == 3, "Statistics: exclusive acquisitions counted");
+        Check (counters.acquired [(int) Windows::RwSpinLockMode::Shared] == 1, "Statistics: shared acquisition counted");
+        Check (counters.contended [(int) Windows::RwSpinLockMode::Exclusive] == 1, "Statistics: contended acquisition counted");
+
+        Policy::Reset ();
+        counters = Policy::Find (&lock);
+        Check (counters.acquired [(int) Windows::RwSpinLockMode::Exclusive] == 0, "Statistics: Reset zeroes the counters");
+    }
+
+    // Timing
+    //  - uncontended waits are recorded as 0 into bucket 0, the contended wait into bucket of its log2
+
+    {
+        using Policy = Windows::RwSpinLockTiming <>;
+        Windows::RwSpinLock <long, Policy> lock;
+        Exercise (lock);
+
+        auto timings = Policy::Find (&lock);
+        Check (timings != nullptr, "Timing: lock is reported");
+        if (timings) {
+            const auto & wait = timings->wait [(int) Windows::RwSpinLockMode::Exclusive];
+            const auto max = static_cast <std::uint64_t> (wait.max);
+
+            Check (wait.buckets [0] == 2, "Timing: uncontended waits are in bucket 0");
+            Check (max >= frequency / 100, "Timing: contended wait is measured");
+
+            auto index = 0u;
+            while (max >> (index + 1)) {
+                ++index;
+            }
+            Check (wait.buckets [index] == 1, "Timing: contended wait is in bucket of its log2");
+        }
+
+        auto hold = Policy::Hold (&lock, Windows::RwSpinLockMode::Exclusive);
+        Check (hold.count == 3, "Timing: exclusive holds are measured");
+        Check (hold.max >= frequency / 100, "Timing: hold awaited by the waiter is measured");
+        Check (Policy::Wait (&lock, Windows::RwSpinLockMode::Exclusive).p50 <= 1, "Timing: median wait is in bucket 0");
+    }
+
+    // Profiler
+    //  - samples every contended acquisition, attributed to the scope function call site
+
+    {
+        using Policy = Windows::RwSpinLockProfiler <64, 1>;
+        Windows::RwSpinLock <long, Policy> lock;
+        Exercise (lock);
+
+        std::size_t sites = 0;
+        Policy::Top (10, [&] (const Policy::CallSite & site) {
+            ++sites;
+            Check (site.lock == &lock && site.samples == 1, "Profiler: contended acquisition is sampled");
+            Check (site.file && std::strstr (site.file, "Policies.cpp"), "Profiler: sample is attributed to the call site");
+        });
+        Check (sites == 1, "Profiler: only the contended site is reported");
+        Check (Policy::Dropped () == 0, "Profiler: no sample dropped");
+    }
+
+    // Trace
+    //  - exported JSON pairs the wait and holds into complete events
+
+    {
+        using Policy = Windows::RwSpinLockTrace <>;
+        Windows::RwSpinLock <long, Policy> lock;
+        Exercise (lock);
+
+        std::string json;
+        if (auto file = std::tmpfile ()) {
+            Policy::Export (file);
+            std::rewind (file);
+
+            char buffer [4096];
+            while (auto n = std::fread (buffer, 1, sizeof buffer, file)) {
+                json.append (buffer, n);
+            }
+            std::fclose (file);
+        }
+
+        Check (json.find ("\"traceEvents\":[") != std::string::npos, "Trace: export writes trace events");
+        Check (json.find ("\"name\":\"wait exclusive\"") != std::string::npos, "Trace: contended wait is exported");
+        Check (json.find ("\"name\":\"shared\"") != std::string::npos, "Trace: shared hold is exported");
+        Check (json.size () > 2 && json.compare (json.size () - 3, 3, "]}\n") == 0, "Trace: JSON is terminated");
+
+        Policy::Clear ();
+        std::size_t events = 0;
+        Policy::Enumerate ([&events] (DWORD, const Policy::Event *, std::size_t n) {
+            events += n;
+        });
+        Check (events == 0, "Trace: Clear discards the events");
+    }
+
+    // Sampler
+    //  - samples every contended acquisition into the waiter's reservoir
+
+    {
+        using Policy = Windows::RwSpinLockSampler <8, 1>;
+        Windows::RwSpinLock <long, Policy> lock;
+        Exercise (lock);
+
+        std::size_t samples = 0;
+        Policy::Enumerate ([&] (DWORD, const Policy::Sample * sample, std::size_t n, long long) {
+            samples += n;
+            Check (sample->lock == &lock && !sample->timeout, "Sampler: contended acquisition is sampled");
+            Check (sample->wait >= frequency / 100, "Sampler: wait is measured");
+        });
+        Check (samples == 1, "Sampler: only the contended acquisition is sampled");
+    }
+
+    // Monitor
+    //  - the segment is never published here, the policy must then only pass through
+
+    {
+        using Policy = Windows::RwSpinLockMonitor <>;
+        Windows::RwSpinLock <long, Policy> lock;
+        Exercise (lock);
+    }
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,239 @@
+#include "Bench.hpp"
+#include "Workload.hpp"
+#include "Histogram.hpp"
+#include "../../Windows_RwSpinLockStatistics.hpp"
+
+#include <cerrno>
+#include <new>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Process
+//  - --threads worker processes are forked, sharing anonymous MAP_SHARED segment that holds the lock,
+//    the Workload (with its BmAlloc bitmap) and per-worker results
+//  - the lock is the only synchronization between the workers, as in the cross-process deployment
+//  - reports throughput and percentiles of exclusive acquisition wait, recorded with RwSpinLockTimestamp
+//  - RwSpinLock needs nothing to work across processes; it is compared against process-shared
+//    pthread_rwlock_t and robust process-shared pthread_mutex_t
+//
+namespace {
+
+    // process-shared lock adapters
+    //  - same interface as the ones in Bench.hpp, constructed in the shared segment before fork
+
+    struct SharedRwLock {
+        static constexpr const char * name = "pthread-rwlock-pshared";
+        static constexpr unsigned width = 0;
+        static constexpr bool shared = true;
+
+        pthread_rwlock_t rwlock;
+
+        SharedRwLock () {
+            pthread_rwlockattr_t attributes;
+            pthread_rwlockattr_init (&attributes);
+            pthread_rwlockattr_setpshared (&attributes, PTHREAD_PROCESS_SHARED);
+            pthread_rwlock_init (&this->rwlock, &attributes);
+            pthread_rwlockattr_destroy (&attributes);
+        }
+        ~SharedRwLock () { pthread_rwlock_destroy (&this->rwlock); }
+
+        void lock () noexcept { pthread_rwlock_wrlock (&this->rwlock); }
+        void unlock () noexcept { pthread_rwlock_unlock (&this->rwlock); }
+        void lock_shared () noexcept { pthread_rwlock_rdlock (&this->rwlock); }
+        void unlock_shared () noexcept { pthread_rwlock_unlock (&this->rwlock); }
+    };
+
+    struct RobustMutex {
+        static constexpr const char * name = "pthread-mutex-robust";
+        static constexpr unsigned width = 0;
+        static constexpr bool shared = false;
+
+        pthread_mutex_t mutex;
+
+        RobustMutex () {
+            pthread_mutexattr_t attributes;
+            pthread_mutexattr_init (&attributes);
+            pthread_mutexattr_setpshared (&attributes, PTHREAD_PROCESS_SHARED);
+            pthread_mutexattr_setrobust (&attributes, PTHREAD_MUTEX_ROBUST);
+            pthread_mutex_init (&this->mutex, &attributes);
+            pthread_mutexattr_destroy (&attributes);
+        }
+        ~RobustMutex () { pthread_mutex_destroy (&this->mutex); }
+
+        void lock () noexcept {
+            if (pthread_mutex_lock (&this->mutex) == EOWNERDEAD) {
+                pthread_mutex_consistent (&this->mutex);
+            }
+        }
+        void unlock () noexcept { pthread_mutex_unlock (&this->mutex); }
+        void lock_shared () noexcept { this->lock (); }
+        void unlock_shared () noexcept { this->unlock (); }
+    };
+
+    // Segment
+    //  - layout of the shared mapping, followed by 'Slot' for each worker
+    //
+    template <typename Lock>
+    struct alignas (64) Segment {
+        Lock lock;
+        Bench::Workload workload;
+        std::atomic <unsigned> ready { 0 };
+        std::atomic <bool> go { false };
+        std::atomic <bool> stop { false };
+
+        struct Slot {
+            Bench::Counters counters;
+            Bench::Histogram waits;
+        };
+
+        Segment (Bench::Workload::Kind kind, unsigned workers) : workload (kind, workers) {}
+
+        Slot * Slots () noexcept {
+            return reinterpret_cast <Slot *> (this + 1);
+        }
+        static std::size_t Size (unsigned workers) noexcept {
+            return sizeof (Segment) + workers * sizeof (Slot);
+        }
+    };
+
+    template <typename Lock>
+    void Worker (Segment <Lock> * segment, unsigned index, int cpu) {
+        if (cpu >= 0) {
+            cpu_set_t set;
+            CPU_ZERO (&set);
+            CPU_SET (cpu, &set);
+            sched_setaffinity (0, sizeof set, &set);
+        }
+
+        auto & slot = segment->Slots () [index];
+        Bench::Timed <Lock, Bench::Histogram> timed { segment->lock, slot.waits };
+        Bench::Workload::Thread thread (index);
+        std::uint64_t operations = 0;
+
+        segment->ready.fetch_add (1);
+        while (!segment->go.load (std::memory_order_acquire)) {
+            sched_yield ();
+        }
+        while (!segment->stop.load (std::memory_order_relaxed)) {
+            segment->workload.Step (timed, thread);
+            ++operations;
+        }
+        slot.counters.operations = operations;
+    }
+
+    template <typename F>
+    void ForEachProcessLock (const Bench::Options & options, F && f) {
+        auto each = [&] (auto tag) {
+            if (options.Selected (decltype (tag)::type::name)) {
+                f (tag);
+            }
+        };
+        Bench::ForEachSpinLock (options, f);
+        each (Bench::Type <SharedRwLock> ());
+        each (Bench::Type <RobustMutex> ());
+    }
+}
+
+bool Bench::Process (const Options & options, Report & report) {
+    const auto frequency = Windows::RwSpinLockTimestampFrequency () / 1e9; // units per nanosecond, calibrate before fork
+    const auto workers = options.threads;
+    const auto cpus = Cpus ();
+    auto success = true;
+
+    ForEachProcessLock (options, [&] (auto tag) {
+        using Lock = typename decltype (tag)::type;
+
+        if (!success)
+            return;
+
+        auto size = Segment <Lock>::Size (workers);
+        auto memory = mmap (nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) {
+            std::fprintf (stderr, "mmap of %zu bytes failed, error %d\n", size, errno);
+            success = false;
+            return;
+        }
+
+        auto segment = new (memory) Segment <Lock> (options.kind, workers);
+        for (auto i = 0u; i != workers; ++i) {
+            new (&segment->Slots () [i]) typename Segment <Lock>::Slot ();
+        }
+
+        std::vector <pid_t> children;
+        for (auto i = 0u; i != workers; ++i) {
+            auto cpu = (options.pin == "compact" && !cpus.empty ()) ? cpus [i % cpus.size ()] : -1;
+            auto pid = fork ();
+            if (pid == 0) {
+                Worker (segment, i, cpu);
+                _exit (0);
+            }
+            if (pid < 0) {
+                std::fprintf (stderr, "fork failed, error %d\n", errno);
+                segment->stop.store (true);
+                segment->go.store (true);
+                success = false;
+                break;
+            }
+            children.push_back (pid);
+        }
+
+        double seconds = 0.0;
+        if (success) {
+            while (segment->ready.load () != workers) {
+                sched_yield ();
+            }
+
+            auto t0 = std::chrono::steady_clock::now ();
+            segment->go.store (true, std::memory_order_release);
+
+            std::this_thread::sleep_for (std::chrono::duration <double> (options.duration));
+            segment->stop.store (true, std::memory_order_relaxed);
+
+            for (auto pid : children) {
+                waitpid (pid, nullptr, 0);
+            }
+            seconds = std::chrono::duration <double> (std::chrono::steady_clock::now () - t0).count ();
+        } else {
+            for (auto pid : children) {
+                waitpid (pid, nullptr, 0);
+            }
+        }
+
+        if (success) {
+            std::uint64_t total = 0;
+            std::uint64_t min = ~0uLL;
+            std::uint64_t max = 0;
+            auto waits = std::make_unique <Histogram> ();
+
+            for (auto i = 0u; i != workers; ++i) {
+                const auto & slot = segment->Slots () [i];
+                total += slot.counters.operations;
+                min = std::min (min, slot.counters.operations);
+                max = std::max (max, slot.counters.operations);
+                waits->Merge (slot.waits);
+            }
+
+            report.Row ({
+                { "mode", "process" },
+                { "lock", Lock::name },
+                { "width", Lock::width },
+                { "workload", options.workload },
+                { "processes", workers },
+                { "seconds", seconds },
+                { "operations", total },
+                { "ops_per_s", total / seconds },
+                { "process_min", min },
+                { "process_max", max },
+                { "p50_ns", waits->Percentile (50.0) / frequency },
+                { "p99_ns", waits->Percentile (99.0) / frequency },
+                { "p999_ns", waits->Percentile (99.9) / frequency },
+                { "max_ns", waits->Max () / frequency },
+            });
+        }
+
+        segment->~Segment ();
+        munmap (memory, size);
+    });
+    return success;
+}
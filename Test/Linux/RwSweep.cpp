@@ -0,0 +1,79 @@
+#include "Bench.hpp"
+#include "Mixed.hpp"
+
+// RwSweep
+//  - sweeps the fraction of shared acquisitions (--reads, percent) against thread count (1, 2, 4 ... --threads)
+//  - readers sum --work words of shared table under shared lock, writers increment them, see Mixed
+//  - reports throughput of reads and writes, and average wait for acquisition of each mode,
+//    measured with RwSpinLockTimestamp
+//
+namespace {
+    struct alignas (64) Tally {
+        std::uint64_t reads = 0;
+        std::uint64_t writes = 0;
+        std::uint64_t read_wait = 0;  // RwSpinLockTimestamp units
+        std::uint64_t write_wait = 0;
+        std::uint64_t checksum = 0;
+    };
+}
+
+bool Bench::RwSweep (const Options & options, Report & report) {
+    auto reads = Numbers (options.reads);
+    if (reads.empty () || options.work == 0) {
+        std::fprintf (stderr, "invalid --reads list or --work\n");
+        return false;
+    }
+
+    const auto frequency = Windows::RwSpinLockTimestampFrequency () / 1e9; // units per nanosecond
+
+    ForEachLock (options, [&] (auto tag) {
+        using Lock = typename decltype (tag)::type;
+
+        for (auto threads : Sweep (options.threads)) {
+            for (auto percent : reads) {
+                auto lock = std::make_unique <Lock> ();
+                std::vector <std::uint64_t> table (options.work);
+                std::vector <Tally> counters (threads);
+
+                auto seconds = Run (options, threads, options.duration, [&] (unsigned index, const std::atomic <bool> & stop) {
+                    Tally c;
+                    c.checksum = Mixed (*lock, table, percent, index, stop, [&c] (bool shared, std::uint64_t wait) {
+                        if (shared) {
+                            ++c.reads;
+                            c.read_wait += wait;
+                        } else {
+                            ++c.writes;
+                            c.write_wait += wait;
+                        }
+                    });
+                    counters [index] = c;
+                });
+
+                Tally total;
+                for (const auto & c : counters) {
+                    total.reads += c.reads;
+                    total.writes += c.writes;
+                    total.read_wait += c.read_wait;
+                    total.write_wait += c.write_wait;
+                }
+
+                report.Row ({
+                    { "mode", "rw-sweep" },
+                    { "lock", Lock::name },
+                    { "width", Lock::width },
+                    { "shared", Lock::shared ? "yes" : "no" },
+                    { "threads", threads },
+                    { "read_pct", percent },
+                    { "work", options.work },
+                    { "seconds", seconds },
+                    { "ops_per_s", (total.reads + total.writes) / seconds },
+                    { "reads_per_s", total.reads / seconds },
+                    { "writes_per_s", total.writes / seconds },
+                    { "read_wait_ns", total.reads ? total.read_wait / frequency / total.reads : 0.0 },
+                    { "write_wait_ns", total.writes ? total.write_wait / frequency / total.writes : 0.0 },
+                });
+            }
+        }
+    });
+    return true;
+}
@@ -0,0 +1,50 @@
+#include "Bench.hpp"
+#include "Workload.hpp"
+
+// Throughput
+//  - all threads run the workload in a loop for the given duration, the BmAllocTest measurement
+//  - reports total operations per second, and the least and most successful thread
+//
+bool Bench::Throughput (const Options & options, Report & report) {
+    ForEachLock (options, [&] (auto tag) {
+        using Lock = typename decltype (tag)::type;
+
+        auto lock = std::make_unique <Lock> ();
+        auto workload = std::make_unique <Workload> (options.kind, options.threads);
+        std::vector <Counters> counters (options.threads);
+
+        auto seconds = Run (options, options.threads, options.duration, [&] (unsigned index, const std::atomic <bool> & stop) {
+            Workload::Thread thread (index);
+            std::uint64_t operations = 0;
+
+            while (!stop.load (std::memory_order_relaxed)) {
+                workload->Step (*lock, thread);
+                ++operations;
+            }
+            counters [index].operations = operations;
+        });
+
+        std::uint64_t total = 0;
+        std::uint64_t min = ~0uLL;
+        std::uint64_t max = 0;
+        for (const auto & c : counters) {
+            total += c.operations;
+            min = std::min (min, c.operations);
+            max = std::max (max, c.operations);
+        }
+
+        report.Row ({
+            { "mode", "throughput" },
+            { "lock", Lock::name },
+            { "width", Lock::width },
+            { "workload", options.workload },
+            { "threads", options.threads },
+            { "seconds", seconds },
+            { "operations", total },
+            { "ops_per_s", total / seconds },
+            { "thread_min", min },
+            { "thread_max", max },
+        });
+    });
+    return true;
+}
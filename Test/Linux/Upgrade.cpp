@@ -0,0 +1,160 @@
+#include "Bench.hpp"
+#include "Mixed.hpp"
+
+// Upgrade
+//  - the README insert-via-upgrade loop: inserters acquire shared lock, traverse --work words of the table
+//    to find the insertion place, attempt to upgrade, insert on success, otherwise release and start over
+//  - --writers inserters (default quarter of --threads) run against 0, 1, 2, 4 ... of the remaining threads
+//    as pure readers (Mixed workload)
+//  - upgrade methods: try   - TryUpgradeToExclusive
+//                     guard - RwSpinLockScopeShared::upgrade guard
+//                     timed - UpgradeToExclusive with 1 ms timeout, competing upgraders wait for each other
+//  - reports inserts/s, reads/s, success rate of upgrade attempts, retries per insert, and traversal time
+//    wasted by failed attempts
+//  - RwSpinLock only, other locks have no upgrade
+//
+namespace {
+    struct alignas (64) Inserts {
+        std::uint64_t inserts = 0;
+        std::uint64_t attempts = 0;
+        std::uint64_t traversal = 0;    // RwSpinLockTimestamp units, all attempts
+        std::uint64_t wasted = 0;       // traversal of failed attempts
+    };
+
+    enum class Method {
+        Try,
+        Guard,
+        Timed
+    };
+
+    const char * const methods [] = { "try", "guard", "timed" };
+
+    std::size_t Traverse (const std::vector <std::uint64_t> & table, std::uint64_t & elapsed) noexcept {
+        auto t0 = Windows::RwSpinLockTimestamp ();
+        std::uint64_t sum = 0;
+        for (auto word : table) {
+            sum += word;
+        }
+        elapsed = Windows::RwSpinLockTimestamp () - t0;
+        return std::size_t (sum % table.size ());
+    }
+
+    // Insert
+    //  - single insertion through the README loop, retried until the upgrade succeeds
+    //  - gives up when 'stop' is set, upgrades may never succeed while readers keep the lock shared
+    //
+    template <typename Spin>
+    void Insert (Spin & spin, std::vector <std::uint64_t> & table, Method method,
+                 const std::atomic <bool> & stop, Inserts & result) noexcept {
+        while (!stop.load (std::memory_order_relaxed)) {
+            std::uint64_t elapsed = 0;
+            auto upgraded = false;
+
+            ++result.attempts;
+            switch (method) {
+                case Method::Try:
+                case Method::Timed:
+                    spin.AcquireShared ();
+                    if (auto place = Traverse (table, elapsed);
+                            method == Method::Try ? spin.TryUpgradeToExclusive () : spin.UpgradeToExclusive (1)) {
+                        table [place] += 1;
+                        spin.ReleaseExclusive ();
+                        upgraded = true;
+                    } else {
+                        spin.ReleaseShared ();
+                    }
+                    break;
+
+                case Method::Guard:
+                    if (auto guard = spin.share ()) {
+                        auto place = Traverse (table, elapsed);
+                        if (auto exclusive = guard.upgrade ()) {
+                            table [place] += 1;
+                            upgraded = true;
+                        }
+                    }
+                    break;
+            }
+
+            result.traversal += elapsed;
+            if (upgraded) {
+                ++result.inserts;
+                return;
+            }
+            result.wasted += elapsed;
+        }
+    }
+}
+
+bool Bench::Upgrade (const Options & options, Report & report) {
+    if (options.work == 0 || options.writers >= options.threads) {
+        std::fprintf (stderr, "invalid --work, or --writers not less than --threads\n");
+        return false;
+    }
+
+    const auto frequency = Windows::RwSpinLockTimestampFrequency () / 1e9; // units per nanosecond
+    const auto inserters = options.writers ? options.writers : std::max (1u, options.threads / 4);
+
+    std::vector <unsigned> readers { 0 };
+    if (options.threads > inserters) {
+        for (auto n : Sweep (options.threads - inserters)) {
+            readers.push_back (n);
+        }
+    }
+
+    ForEachSpinLock (options, [&] (auto tag) {
+        using Lock = typename decltype (tag)::type;
+
+        for (auto method : { Method::Try, Method::Guard, Method::Timed }) {
+            for (auto n : readers) {
+                auto lock = std::make_unique <Lock> ();
+                std::vector <std::uint64_t> table (options.work);
+                std::vector <Inserts> results (inserters);
+                std::vector <Counters> reads (n);
+
+                auto seconds = Run (options, inserters + n, options.duration, [&] (unsigned index, const std::atomic <bool> & stop) {
+                    if (index < inserters) {
+                        Inserts result;
+                        while (!stop.load (std::memory_order_relaxed)) {
+                            Insert (lock->spin, table, method, stop, result);
+                        }
+                        results [index] = result;
+                    } else {
+                        std::uint64_t operations = 0;
+                        Mixed (*lock, table, 100.0, index, stop, [&operations] (bool, std::uint64_t) { ++operations; });
+                        reads [index - inserters].operations = operations;
+                    }
+                });
+
+                Inserts total;
+                for (const auto & r : results) {
+                    total.inserts += r.inserts;
+                    total.attempts += r.attempts;
+                    total.traversal += r.traversal;
+                    total.wasted += r.wasted;
+                }
+                std::uint64_t shared = 0;
+                for (const auto & r : reads) {
+                    shared += r.operations;
+                }
+
+                report.Row ({
+                    { "mode", "upgrade" },
+                    { "lock", Lock::name },
+                    { "width", Lock::width },
+                    { "method", methods [int (method)] },
+                    { "inserters", inserters },
+                    { "readers", n },
+                    { "seconds", seconds },
+                    { "inserts_per_s", total.inserts / seconds },
+                    { "reads_per_s", shared / seconds },
+                    { "success_pct", total.attempts ? 100.0 * total.inserts / total.attempts : 0.0 },
+                    { "retries_per_insert", total.inserts ? double (total.attempts - total.inserts) / total.inserts : 0.0 },
+                    { "wasted_ns_per_insert", total.inserts ? total.wasted / frequency / total.inserts : 0.0 },
+                    { "wasted_pct", total.traversal ? 100.0 * total.wasted / total.traversal : 0.0 },
+                });
+            }
+        }
+    });
+    return true;
+}
@@ -0,0 +1,299 @@
+#ifndef WINDOWS_LINUX_SHIM_H
+#define WINDOWS_LINUX_SHIM_H
+
+// Windows.h (Linux)
+//  - minimal Win32 subset needed by Windows_RwSpinLock.hpp, Windows_RwSpinLockStatistics.hpp,
+//    Windows_RwSpinLockAsync.hpp, Windows_RwSpinLockPerCpu.hpp, the instrumentation policies
+//    except ETW and watchdog, and BmAlloc.cpp, so that the lock can be benchmarked on Linux, see LockBench.cpp
+//  - NOT a general purpose compatibility layer, used only by the benchmark build
+//  - NOTE: Linux is LP64, 'long' is 64-bit wide there, RwSpinLock <long> thus uses 64-bit state
+//
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "intrin.h"
+
+typedef int BOOL;
+typedef unsigned char BOOLEAN;
+typedef std::uint32_t DWORD;
+typedef std::int32_t LONG;
+typedef unsigned long ULONG;
+typedef unsigned long long ULONGLONG;
+typedef unsigned long long DWORD64;
+typedef unsigned short WORD;
+typedef unsigned char BYTE;
+typedef void VOID;
+typedef void * PVOID;
+typedef void * LPVOID;
+typedef void * HANDLE;
+
+union LARGE_INTEGER {
+    struct {
+        DWORD LowPart;
+        LONG HighPart;
+    };
+    long long QuadPart;
+};
+
+union ULARGE_INTEGER {
+    struct {
+        DWORD LowPart;
+        DWORD HighPart;
+    };
+    unsigned long long QuadPart;
+};
+
+struct FILETIME {
+    DWORD dwLowDateTime;
+    DWORD dwHighDateTime;
+};
+
+#define WINAPI
+#define CALLBACK
+#define TRUE 1
+#define FALSE 0
+#define INFINITE 0xFFFFFFFF
+
+// interlocked operations
+//  - sequentially consistent, as full barriers on Windows
+
+inline short InterlockedCompareExchange16 (volatile short * dst, short x, short cmp) noexcept { return __sync_val_compare_and_swap (dst, cmp, x); }
+inline long InterlockedCompareExchange (volatile long * dst, long x, long cmp) noexcept { return __sync_val_compare_and_swap (dst, cmp, x); }
+inline long long InterlockedCompareExchange64 (volatile long long * dst, long long x, long long cmp) noexcept { return __sync_val_compare_and_swap (dst, cmp, x); }
+inline PVOID InterlockedCompareExchangePointer (PVOID volatile * dst, PVOID x, PVOID cmp) noexcept { return __sync_val_compare_and_swap (dst, cmp, x); }
+
+inline short InterlockedExchange16 (volatile short * dst, short x) noexcept { return __atomic_exchange_n (dst, x, __ATOMIC_SEQ_CST); }
+inline long InterlockedExchange (volatile long * dst, long x) noexcept { return __atomic_exchange_n (dst, x, __ATOMIC_SEQ_CST); }
+inline long long InterlockedExchange64 (volatile long long * dst, long long x) noexcept { return __atomic_exchange_n (dst, x, __ATOMIC_SEQ_CST); }
+
+inline short InterlockedIncrement16 (volatile short * dst) noexcept { return __atomic_add_fetch (dst, 1, __ATOMIC_SEQ_CST); }
+inline long InterlockedIncrement (volatile long * dst) noexcept { return __atomic_add_fetch (dst, 1, __ATOMIC_SEQ_CST); }
+inline long long InterlockedIncrement64 (volatile long long * dst) noexcept { return __atomic_add_fetch (dst, 1, __ATOMIC_SEQ_CST); }
+
+inline short InterlockedDecrement16 (volatile short * dst) noexcept { return __atomic_sub_fetch (dst, 1, __ATOMIC_SEQ_CST); }
+inline long InterlockedDecrement (volatile long * dst) noexcept { return __atomic_sub_fetch (dst, 1, __ATOMIC_SEQ_CST); }
+inline long long InterlockedDecrement64 (volatile long long * dst) noexcept { return __atomic_sub_fetch (dst, 1, __ATOMIC_SEQ_CST); }
+
+inline long InterlockedExchangeAdd (volatile long * dst, long x) noexcept { return __atomic_fetch_add (dst, x, __ATOMIC_SEQ_CST); }
+inline long long InterlockedExchangeAdd64 (volatile long long * dst, long long x) noexcept { return __atomic_fetch_add (dst, x, __ATOMIC_SEQ_CST); }
+
+// scheduling
+//  - Sleep (0) and SwitchToThread both map to sched_yield, Linux has no distinction of the two
+//  - processor number is sched_getcpu, split into groups of 64 as on Windows
+
+inline void YieldProcessor () noexcept {
+#if defined (__x86_64__) || defined (__i386__)
+    __builtin_ia32_pause ();
+#elif defined (__aarch64__) || defined (__arm__)
+    __asm__ __volatile__ ("yield");
+#endif
+}
+
+inline DWORD GetCurrentThreadId () noexcept {
+    return DWORD (syscall (SYS_gettid));
+}
+
+inline DWORD GetCurrentProcessId () noexcept {
+    return DWORD (getpid ());
+}
+
+inline BOOL SwitchToThread () noexcept {
+    return sched_yield () == 0;
+}
+
+struct PROCESSOR_NUMBER {
+    WORD Group;
+    BYTE Number;
+    BYTE Reserved;
+};
+
+inline void GetCurrentProcessorNumberEx (PROCESSOR_NUMBER * processor) noexcept {
+    auto cpu = sched_getcpu ();
+    if (cpu < 0) {
+        cpu = 0;
+    }
+    processor->Group = WORD (cpu / 64);
+    processor->Number = BYTE (cpu % 64);
+    processor->Reserved = 0;
+}
+
+inline void Sleep (DWORD ms) noexcept {
+    if (ms) {
+        timespec t = { time_t (ms / 1000), long (ms % 1000) * 1000000L };
+        nanosleep (&t, nullptr);
+    } else {
+        sched_yield ();
+    }
+}
+
+// time
+//  - performance counter is CLOCK_MONOTONIC in nanoseconds
+
+inline BOOL QueryPerformanceCounter (LARGE_INTEGER * counter) noexcept {
+    timespec t;
+    clock_gettime (CLOCK_MONOTONIC, &t);
+    counter->QuadPart = t.tv_sec * 1000000000LL + t.tv_nsec;
+    return TRUE;
+}
+
+inline BOOL QueryPerformanceFrequency (LARGE_INTEGER * frequency) noexcept {
+    frequency->QuadPart = 1000000000LL;
+    return TRUE;
+}
+
+inline ULONGLONG GetTickCount64 () noexcept {
+    timespec t;
+    clock_gettime (CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000uLL + t.tv_nsec / 1000000;
+}
+
+// thread pool timers
+//  - single process-wide pool of worker threads, one per CPU, running callbacks of expired timers
+//  - due time: negative is relative in 100ns units, non-negative is absolute FILETIME, which is always
+//    taken as already passed (all absolute times the library uses are zero), null cancels the timer
+//  - callback environment is ignored, period and window length must be 0
+//  - CloseThreadpoolTimer cancels pending callback, the timer is freed after its running callback returns
+
+struct TP_CALLBACK_INSTANCE;
+struct TP_CALLBACK_ENVIRON;
+struct TP_TIMER;
+
+typedef TP_CALLBACK_INSTANCE * PTP_CALLBACK_INSTANCE;
+typedef TP_CALLBACK_ENVIRON * PTP_CALLBACK_ENVIRON;
+typedef TP_TIMER * PTP_TIMER;
+typedef void (*PTP_TIMER_CALLBACK) (PTP_CALLBACK_INSTANCE, PVOID, PTP_TIMER);
+
+struct TP_TIMER {
+    using Clock = std::chrono::steady_clock;
+    using Queue = std::multimap <Clock::time_point, TP_TIMER *>;
+
+    PTP_TIMER_CALLBACK callback;
+    PVOID context;
+    Queue::iterator pending;
+    bool armed = false;
+    bool running = false;
+    bool closed = false;
+
+    // Pool
+    //  - intentionally leaked, the workers run until the process exits
+    //
+    struct Pool {
+        std::mutex mutex;
+        std::condition_variable wake;
+        Queue queue;
+
+        Pool () {
+            for (auto i = std::max (2u, std::thread::hardware_concurrency ()); i; --i) {
+                std::thread ([this] { this->Work (); }).detach ();
+            }
+        }
+
+        void Work () {
+            std::unique_lock <std::mutex> guard (this->mutex);
+            while (true) {
+                if (this->queue.empty ()) {
+                    this->wake.wait (guard);
+                } else if (this->queue.begin ()->first > Clock::now ()) {
+                    this->wake.wait_until (guard, this->queue.begin ()->first);
+                } else {
+                    auto timer = this->queue.begin ()->second;
+                    this->queue.erase (this->queue.begin ());
+                    timer->armed = false;
+                    timer->running = true;
+
+                    guard.unlock ();
+                    timer->callback (nullptr, timer->context, timer);
+                    guard.lock ();
+
+                    timer->running = false;
+                    if (timer->closed) {
+                        delete timer;
+                    }
+                }
+            }
+        }
+
+        static Pool & Instance () {
+            static auto pool = new Pool;
+            return *pool;
+        }
+    };
+};
+
+inline PTP_TIMER CreateThreadpoolTimer (PTP_TIMER_CALLBACK callback, PVOID context, PTP_CALLBACK_ENVIRON) noexcept {
+    TP_TIMER::Pool::Instance ();
+    return new (std::nothrow) TP_TIMER { callback, context, {} };
+}
+
+inline void SetThreadpoolTimer (PTP_TIMER timer, FILETIME * due, DWORD, DWORD) noexcept {
+    auto & pool = TP_TIMER::Pool::Instance ();
+    std::lock_guard <std::mutex> guard (pool.mutex);
+
+    if (timer->armed) {
+        pool.queue.erase (timer->pending);
+        timer->armed = false;
+    }
+    if (due) {
+        auto when = TP_TIMER::Clock::now ();
+        auto value = (long long) (((unsigned long long) due->dwHighDateTime << 32) | due->dwLowDateTime);
+        if (value < 0) {
+            when += std::chrono::nanoseconds (-value * 100);
+        }
+        timer->pending = pool.queue.emplace (when, timer);
+        timer->armed = true;
+        pool.wake.notify_one ();
+    }
+}
+
+inline void CloseThreadpoolTimer (PTP_TIMER timer) noexcept {
+    auto & pool = TP_TIMER::Pool::Instance ();
+    std::lock_guard <std::mutex> guard (pool.mutex);
+
+    if (timer->armed) {
+        pool.queue.erase (timer->pending);
+    }
+    if (timer->running) {
+        timer->closed = true;
+    } else {
+        delete timer;
+    }
+}
+
+// handles
+//  - declared only, so that Windows_RwSpinLockAsync.hpp, Windows_RwSpinLockSampler.hpp and
+//    Windows_RwSpinLockMonitor.hpp compile; notify_exclusively/notify_share, RwSpinLockSampler::Listen
+//    and RwSpinLockMonitor::Publish/Name use Win32 events or file mappings and are thus not available on Linux
+
+#define DUPLICATE_SAME_ACCESS 0x00000002
+#define ERROR_ALREADY_EXISTS 183
+#define FILE_MAP_WRITE 0x0002
+#define INVALID_HANDLE_VALUE ((HANDLE) (long) -1)
+#define PAGE_READWRITE 0x04
+#define WT_EXECUTEDEFAULT 0x00000000
+
+typedef void (*WAITORTIMERCALLBACK) (PVOID, BOOLEAN);
+
+HANDLE GetCurrentProcess () noexcept;
+BOOL DuplicateHandle (HANDLE, HANDLE, HANDLE, HANDLE *, DWORD, BOOL, DWORD) noexcept;
+HANDLE CreateEventW (void *, BOOL, BOOL, const wchar_t *) noexcept;
+BOOL SetEvent (HANDLE) noexcept;
+BOOL RegisterWaitForSingleObject (HANDLE *, HANDLE, WAITORTIMERCALLBACK, PVOID, DWORD, ULONG) noexcept;
+HANDLE CreateFileMappingW (HANDLE, void *, DWORD, DWORD, DWORD, const wchar_t *) noexcept;
+LPVOID MapViewOfFile (HANDLE, DWORD, DWORD, DWORD, std::size_t) noexcept;
+BOOL UnmapViewOfFile (const void *) noexcept;
+DWORD GetLastError () noexcept;
+BOOL CloseHandle (HANDLE) noexcept;
+
+#endif
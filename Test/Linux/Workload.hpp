@@ -0,0 +1,95 @@
+#ifndef BENCH_WORKLOAD_HPP
+#define BENCH_WORKLOAD_HPP
+
+#include "Bench.hpp"
+#include "../BmAlloc.hpp"
+
+namespace Bench {
+
+    // Workload
+    //  - the protected data and the critical section performed on it under exclusive lock
+    //  - bmalloc - BmAlloc over 2048-bit bitmap, as in BmAllocTest: each thread allocates random number
+    //              of bits, one per acquisition, and then releases them, again one per acquisition
+    //  - counter - increments single shared counter, shortest meaningful critical section
+    //
+    class Workload {
+    public:
+        using Kind = WorkloadKind;
+
+        // Thread
+        //  - state of a single thread
+        //
+        struct Thread {
+            std::vector <std::size_t> held;
+            std::size_t target = 0;
+            std::uint32_t random;
+
+            explicit Thread (unsigned index) : random (2463534242u + 0x9E3779B9u * index) {}
+
+            std::uint32_t Random () noexcept {
+                this->random ^= this->random << 13;
+                this->random ^= this->random >> 17;
+                this->random ^= this->random << 5;
+                return this->random;
+            }
+        };
+
+    private:
+        Kind kind;
+        std::size_t quota;
+        std::intptr_t data [32] = {};
+        BmAlloc allocator;
+        volatile std::uint64_t counter = 0;
+
+    public:
+        static constexpr std::size_t Bits = 8 * sizeof (std::intptr_t) * 32;
+
+        Workload (Kind kind, unsigned threads)
+            : kind (kind)
+            , quota (std::max <std::size_t> (1, Bits / std::max (1u, threads)))
+            , allocator (data, Bits) {}
+
+        // Step
+        //  - single acquisition of 'lock' performing one operation of the workload
+        //
+        template <typename Lock>
+        void Step (Lock & lock, Thread & thread) {
+            switch (this->kind) {
+                case Kind::bmalloc:
+                    if (thread.target == 0) {
+                        thread.target = 1 + thread.Random () % this->quota;
+                    }
+                    if (thread.held.size () < thread.target) {
+                        std::size_t index = 0;
+                        lock.lock ();
+                        auto acquired = this->allocator.acquire (&index);
+                        lock.unlock ();
+
+                        if (acquired) {
+                            thread.held.push_back (index);
+                        } else {
+                            thread.target = thread.held.size ();
+                        }
+                    } else {
+                        lock.lock ();
+                        this->allocator.release (thread.held.back ());
+                        lock.unlock ();
+
+                        thread.held.pop_back ();
+                        if (thread.held.empty ()) {
+                            thread.target = 0;
+                        }
+                    }
+                    break;
+
+                case Kind::counter:
+                    lock.lock ();
+                    this->counter = this->counter + 1;
+                    lock.unlock ();
+                    break;
+            }
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef WINDOWS_LINUX_SHIM_INTRIN_H
+#define WINDOWS_LINUX_SHIM_INTRIN_H
+
+// intrin.h (Linux)
+//  - MSVC intrinsics used by Windows_RwSpinLock.hpp, Windows_RwSpinLockStatistics.hpp and BmAlloc.cpp
+//  - defines _M_AMD64/_M_IX86 and _WIN64 the way MSVC does, so that the same code paths are compiled
+//
+
+#include <cstdint>
+
+#if defined (__x86_64__)
+#define _M_AMD64 100
+#elif defined (__i386__)
+#define _M_IX86 600
+#endif
+
+#if defined (__x86_64__) || defined (__aarch64__)
+#define _WIN64 1
+#endif
+
+#if defined (__x86_64__) || defined (__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+
+#undef __cpuid
+inline void __cpuid (int info [4], int leaf) noexcept {
+    __cpuid_count (leaf, 0, info [0], info [1], info [2], info [3]);
+}
+#endif
+
+inline unsigned char _BitScanForward (unsigned long * index, unsigned long mask) noexcept {
+    if (!mask)
+        return 0;
+    *index = __builtin_ctzl (mask);
+    return 1;
+}
+inline unsigned char _BitScanForward64 (unsigned long * index, unsigned long long mask) noexcept {
+    if (!mask)
+        return 0;
+    *index = __builtin_ctzll (mask);
+    return 1;
+}
+inline unsigned char _BitScanReverse64 (unsigned long * index, unsigned long long mask) noexcept {
+    if (!mask)
+        return 0;
+    *index = 63 - __builtin_clzll (mask);
+    return 1;
+}
+
+inline unsigned char _bittestandreset (std::int32_t * word, std::int32_t index) noexcept {
+    auto bit = std::int32_t (1) << index;
+    auto previous = *word & bit;
+    *word &= ~bit;
+    return previous != 0;
+}
+inline unsigned char _bittestandreset64 (std::int64_t * word, std::int64_t index) noexcept {
+    auto bit = std::int64_t (1) << index;
+    auto previous = *word & bit;
+    *word &= ~bit;
+    return previous != 0;
+}
+
+#endif
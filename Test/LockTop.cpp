@@ -0,0 +1,193 @@
+#include <Windows.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <cwchar>
+#include <vector>
+
+#include "../Windows_RwSpinLockMonitor.hpp"
+
+// LockTop
+//  - live view of locks published by Windows::RwSpinLockMonitor in other process, attaches read-only
+//  - command-line: "LockTop <process id | segment name> [interval ms] [sort: wait|acquired|contention]"
+
+using Segment = Windows::RwSpinLockMonitorSegment;
+
+struct Row {
+    const Segment::Entry * entry;
+    double acquired;    // per second
+    double contention;  // percent of acquisitions that had to wait
+    double average;     // microseconds
+    double p99;         // microseconds, upper bound of the bucket
+    double timeouts;    // per second
+    double waited;      // total wait, microseconds per second
+};
+
+// Order
+//  - column the rows are sorted by, descending
+//
+enum class Order {
+    wait,
+    acquired,
+    contention
+};
+
+Order order = Order::wait;
+
+// Snapshot
+//  - copy of counters needed to compute rates between two refreshes
+//
+struct Snapshot {
+    long long lock;
+    long long acquired;
+    long long contended;
+    long long timeouts;
+    long long waited;
+    long long buckets [Segment::Buckets];
+};
+
+Snapshot take (const Segment::Entry & entry) {
+    Snapshot s = {};
+    s.lock = entry.lock;
+    for (auto m = 0; m != 3; ++m) {
+        s.acquired += entry.acquired [m];
+        s.contended += entry.contended [m];
+        s.timeouts += entry.timeouts [m];
+        s.waited += entry.waited [m];
+    }
+    for (auto b = 0u; b != Segment::Buckets; ++b) {
+        s.buckets [b] = entry.buckets [b];
+    }
+    return s;
+}
+
+int wmain (int argc, wchar_t ** argv) {
+    if (argc < 2) {
+        std::fwprintf (stderr, L"usage: LockTop <process id | segment name> [interval ms] [wait|acquired|contention]\n");
+        return 1;
+    }
+
+    wchar_t name [64];
+    if (auto pid = std::wcstoul (argv [1], nullptr, 10)) {
+        Segment::Name (name, pid);
+    } else {
+        std::swprintf (name, 64, L"%ls", argv [1]);
+    }
+
+    DWORD interval = 1000;
+    if (argc > 2) {
+        interval = std::wcstoul (argv [2], nullptr, 10);
+    }
+    if (argc > 3) {
+        if (std::wcscmp (argv [3], L"acquired") == 0) order = Order::acquired;
+        if (std::wcscmp (argv [3], L"contention") == 0) order = Order::contention;
+    }
+
+    auto mapping = OpenFileMappingW (FILE_MAP_READ, FALSE, name);
+    if (!mapping) {
+        std::fwprintf (stderr, L"cannot open %ls: error %u\n", name, GetLastError ());
+        return 2;
+    }
+    auto header = static_cast <const Segment::Header *> (MapViewOfFile (mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!header || header->magic != Segment::Magic || header->version != Segment::Version) {
+        std::fwprintf (stderr, L"%ls is not a compatible RwSpinLockMonitor segment\n", name);
+        return 3;
+    }
+
+    DWORD mode = 0;
+    auto console = GetStdHandle (STD_OUTPUT_HANDLE);
+    if (GetConsoleMode (console, &mode)) {
+        SetConsoleMode (console, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+    }
+
+    const auto entries = Segment::Entries (header);
+    const auto capacity = header->capacity;
+    const auto frequency = header->frequency / 1000000.0; // units per microsecond
+
+    std::vector <Snapshot> previous (capacity);
+    for (auto i = 0u; i != capacity; ++i) {
+        previous [i] = take (entries [i]);
+    }
+    auto t0 = GetTickCount64 ();
+
+    while (true) {
+        Sleep (interval);
+
+        auto t1 = GetTickCount64 ();
+        auto seconds = (t1 - t0) / 1000.0;
+        t0 = t1;
+
+        std::vector <Row> rows;
+        for (auto i = 0u; i != capacity; ++i) {
+            auto current = take (entries [i]);
+            if (current.lock == 0)
+                continue;
+
+            auto & last = previous [i];
+            if (last.lock != current.lock) {
+                last = {};
+            }
+
+            Row row = {};
+            row.entry = &entries [i];
+
+            auto acquired = current.acquired - last.acquired;
+            auto contended = current.contended - last.contended;
+
+            row.acquired = acquired / seconds;
+            row.timeouts = (current.timeouts - last.timeouts) / seconds;
+            row.waited = (current.waited - last.waited) / frequency / seconds;
+            if (acquired) {
+                row.contention = 100.0 * contended / acquired;
+            }
+            if (contended) {
+                row.average = (current.waited - last.waited) / frequency / contended;
+
+                long long n = 0;
+                for (auto b = 0u; b != Segment::Buckets; ++b) {
+                    n += current.buckets [b] - last.buckets [b];
+                    if (n * 100 >= contended * 99) {
+                        row.p99 = double (2uLL << b) / frequency;
+                        break;
+                    }
+                }
+            }
+            rows.push_back (row);
+            last = current;
+        }
+
+        std::sort (rows.begin (), rows.end (), [] (const Row & a, const Row & b) {
+            switch (order) {
+                case Order::acquired: return a.acquired > b.acquired;
+                case Order::contention: return a.contention > b.contention;
+                default: return a.waited > b.waited;
+            }
+        });
+
+        std::printf ("\x1b[2J\x1b[H");
+        std::printf ("process %u, %u locks, %lld events of unmonitored locks, refresh %u ms\n\n",
+                     header->process, (unsigned) rows.size (), header->dropped, interval);
+        std::printf ("%-32s %12s %8s %12s %12s %10s  %s\n",
+                     "lock", "acquired/s", "cont %", "avg wait us", "p99 wait us", "timeout/s", "state");
+
+        for (const auto & row : rows) {
+            char label [64];
+            if (row.entry->name [0]) {
+                std::snprintf (label, sizeof label, "%.47s", row.entry->name);
+            } else {
+                std::snprintf (label, sizeof label, "0x%llx", (unsigned long long) row.entry->lock);
+            }
+
+            char state [32] = "free";
+            if (row.entry->exclusive) {
+                std::snprintf (state, sizeof state, "exclusive");
+            } else
+            if (auto readers = row.entry->readers) {
+                std::snprintf (state, sizeof state, "shared %ld", readers);
+            }
+
+            std::printf ("%-32.32s %12.0f %8.2f %12.2f %12.2f %10.1f  %s\n",
+                         label, row.acquired, row.contention, row.average, row.p99, row.timeouts, state);
+        }
+    }
+}
@@ -0,0 +1,96 @@
+#include <Windows.h>
+#include <cstdio>
+#include <thread>
+
+#include "../Windows_RwSpinLockStatistics.hpp"
+#include "../Windows_RwSpinLockTiming.hpp"
+#include "../Windows_RwSpinLockProfiler.hpp"
+#include "../Windows_RwSpinLockTrace.hpp"
+#include "../Windows_RwSpinLockEtw.hpp"
+#include "../Windows_RwSpinLockMonitor.hpp"
+#include "../Windows_RwSpinLockWatchdog.hpp"
+#include "../Windows_RwSpinLockSampler.hpp"
+#include "../Windows_RwSpinLockPerCpu.hpp"
+
+// Policies
+//  - "BmAllocTest policies" - instantiates RwSpinLock with every instrumentation policy, including those
+//    the Linux shim can't compile (ETW, watchdog), and runs the same acquisitions through each one
+//  - behaviour of the others is tested on Linux, see Linux/Policies.cpp
+//  - returns number of failures
+//
+
+TRACELOGGING_DEFINE_PROVIDER (PoliciesProvider, "RwSpinLock.Test",
+                              (0x5D3A4C0E, 0x2B7F, 0x4E61, 0x9A8C, 0x1F0B6E2D7C43));
+
+namespace {
+    int failures = 0;
+
+    void Check (bool condition, const char * what) {
+        std::printf ("%s: %s\n", condition ? "ok" : "FAILED", what);
+        if (!condition) {
+            ++failures;
+        }
+    }
+
+    // Exercise
+    //  - uncontended exclusive and shared scope, and exclusive acquisition waiting for other thread
+    //
+    template <typename Lock>
+    void Exercise (Lock & lock, const char * name) {
+        {
+            auto guard = lock.exclusively ();
+            Check (guard && lock.IsLockedExclusively (), name);
+        }
+        {
+            auto guard = lock.share ();
+            Check (guard && lock.IsLocked () && !lock.IsLockedExclusively (), name);
+        }
+
+        lock.AcquireExclusive ();
+        std::thread waiter ([&lock] {
+            auto guard = lock.exclusively ();
+        });
+        Sleep (20);
+        lock.ReleaseExclusive ();
+        waiter.join ();
+
+        Check (!lock.IsLocked (), name);
+    }
+
+    template <typename Policy>
+    void Exercise (const char * name) {
+        Windows::RwSpinLock <long, Policy> lock;
+        Exercise (lock, name);
+    }
+}
+
+int Policies () {
+    TraceLoggingRegister (PoliciesProvider);
+
+    Exercise <Windows::RwSpinLockStatistics <>> ("Statistics");
+    Exercise <Windows::RwSpinLockTiming <>> ("Timing");
+    Exercise <Windows::RwSpinLockProfiler <>> ("Profiler");
+    Exercise <Windows::RwSpinLockTrace <>> ("Trace");
+    Exercise <Windows::RwSpinLockEtw <PoliciesProvider>> ("Etw");
+    Exercise <Windows::RwSpinLockMonitor <>> ("Monitor");
+    Exercise <Windows::RwSpinLockSampler <>> ("Sampler");
+    Exercise <Windows::RwSpinLockStatisticsChain <Windows::RwSpinLockStatistics <>, Windows::RwSpinLockTiming <>>> ("Chain");
+
+    {
+        using Watchdog = Windows::RwSpinLockWatchdog <>;
+        Windows::RwSpinLock <long, Watchdog> lock;
+        Exercise (lock, "Watchdog");
+
+        lock.AcquireExclusive ();
+        Check (Watchdog::Owner (&lock) == GetCurrentThreadId (), "Watchdog: owner is recorded");
+        lock.ReleaseExclusive ();
+        Check (Watchdog::Owner (&lock) == 0, "Watchdog: owner is cleared on release");
+    }
+    {
+        Windows::RwSpinLockPerCpu <> lock;
+        Exercise (lock, "PerCpu");
+    }
+
+    TraceLoggingUnregister (PoliciesProvider);
+    return failures;
+}
@@ -2,23 +2,289 @@
 #define WINDOWS_RWSPINLOCK_HPP
 
 #include <Windows.h>
+#include <intrin.h>
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
+
+#if __has_include (<version>)
+#include <version>
+#endif
+#ifdef __cpp_lib_source_location
+#include <source_location>
+#endif
 
 namespace Windows {
-    template <typename StateType> class RwSpinLockScopeShared;
-    template <typename StateType> class RwSpinLockScopeUpgraded;
-    template <typename StateType> class RwSpinLockScopeExclusive;
-    template <typename StateType> class RwSpinLockScopeSharedUnlocked;
-    template <typename StateType> class RwSpinLockScopeExclusiveUnlocked;
+    struct RwSpinLockNoStatistics;
+
+    template <typename StateType, typename Stats = RwSpinLockNoStatistics> class RwSpinLockScopeShared;
+    template <typename StateType, typename Stats = RwSpinLockNoStatistics> class RwSpinLockScopeUpgraded;
+    template <typename StateType, typename Stats = RwSpinLockNoStatistics> class RwSpinLockScopeExclusive;
+    template <typename StateType, typename Stats = RwSpinLockNoStatistics> class RwSpinLockScopeSharedUnlocked;
+    template <typename StateType, typename Stats = RwSpinLockNoStatistics> class RwSpinLockScopeExclusiveUnlocked;
+
+    // RwSpinLockPhase
+    //  - escalation phases of waiting for contended lock
+    //
+    enum class RwSpinLockPhase {
+        Pause,      // YieldProcessor
+        Yield,      // SwitchToThread
+        Sleep0,     // Sleep (0)
+        Sleep1,     // Sleep (1)
+        Park,       // Sleep (1) while culled by RwSpinLockAdmission
+    };
+
+    // RwSpinLockMode
+    //  - access mode, as reported to Stats policy
+    //
+    enum class RwSpinLockMode {
+        Exclusive,
+        Shared,
+        Upgrade,    // shared lock upgraded to exclusive, released by DowngradeToShared or ReleaseExclusive
+    };
+
+    // RwSpinLockSite
+    //  - source location of the caller of scope functions (exclusively, share, upgrade), as reported to Stats policy
+    //  - captured by default argument, std::source_location when available, compiler builtins otherwise
+    //  - the strings are literals with static storage duration
+    //
+    struct RwSpinLockSite {
+        const char * file;
+        const char * function;
+        std::uint32_t line;
+
+#ifdef __cpp_lib_source_location
+        static constexpr RwSpinLockSite Current (std::source_location location = std::source_location::current ()) noexcept {
+            return { location.file_name (), location.function_name (), location.line () };
+        }
+#else
+        static constexpr RwSpinLockSite Current (const char * file = __builtin_FILE (),
+                                                 const char * function = __builtin_FUNCTION (),
+                                                 std::uint32_t line = __builtin_LINE ()) noexcept {
+            return { file, function, line };
+        }
+#endif
+    };
+
+    // RwSpinLockWaitProfile
+    //  - where the waiting time went, arrays are indexed by RwSpinLockPhase
+    //  - filled by Acquire*/UpgradeToExclusive overloads and scope functions taking reference to it,
+    //    all zero when the lock was acquired without waiting
+    //
+    struct RwSpinLockWaitProfile {
+        std::uint32_t count [5];    // rounds spent in each phase: YieldProcessor, SwitchToThread, Sleep (0), Sleep (1), parked
+        std::uint64_t elapsed [5];  // nanoseconds spent in each phase
+
+        // Rounds/Elapsed
+        //  - totals, Rounds is the number reported through 'rounds' parameter of other overloads,
+        //    on timeout including the last round, counted in its phase but not spent waiting
+        //
+        inline std::uint32_t Rounds () const noexcept {
+            return this->count [0] + this->count [1] + this->count [2] + this->count [3] + this->count [4];
+        }
+        inline std::uint64_t Elapsed () const noexcept {
+            return this->elapsed [0] + this->elapsed [1] + this->elapsed [2] + this->elapsed [3] + this->elapsed [4];
+        }
+    };
+
+    // RwSpinLockAcquireResult
+    //  - diagnostics of timed acquisition or upgrade, filled by AcquireExclusive, AcquireShared
+    //    and UpgradeToExclusive overloads taking reference to it
+    //  - 'state' and 'owner' are captured only on failure, to tell "many readers" from "stuck writer"
+    //
+    struct RwSpinLockAcquireResult {
+        long long state;                // lock state at timeout: -1 exclusively owned, otherwise number of readers; 0 on success
+        DWORD owner;                    // thread id of the exclusive owner, if tracked by the Stats policy (RwSpinLockWatchdog)
+        RwSpinLockWaitProfile profile;
+    };
+
+    // RwSpinLockNoStatistics
+    //  - default Stats policy of RwSpinLock, all calls compile to nothing
+    //  - Stats policy is a class with following static member functions, 'lock' is address of the RwSpinLock:
+    //     - Acquired (lock, mode, rounds) - successful acquisition or upgrade, 'rounds' is 0 when uncontended
+    //     - Released (lock, mode) - ReleaseExclusive, ReleaseShared, or DowngradeToShared with mode Upgrade
+    //     - Phase (lock, mode, phase) - waiting thread reached next escalation phase, called once per phase
+    //     - Timeout (lock, mode, rounds) - timed acquisition or upgrade failed
+    //     - UpgradeFailed (lock) - TryUpgradeToExclusive failed
+    //     - Site (lock, mode, site) - scope function is about to acquire or upgrade the lock, on behalf of 'site'
+    //     - Owner (lock) - returns thread id of the exclusive owner, if the policy tracks it, otherwise 0
+    //  - the calls are made only from the thread that performs the operation
+    //
+    struct RwSpinLockNoStatistics {
+        static inline void Acquired (const void *, RwSpinLockMode, std::uint32_t) noexcept {}
+        static inline void Released (const void *, RwSpinLockMode) noexcept {}
+        static inline void Phase (const void *, RwSpinLockMode, RwSpinLockPhase) noexcept {}
+        static inline void Timeout (const void *, RwSpinLockMode, std::uint32_t) noexcept {}
+        static inline void UpgradeFailed (const void *) noexcept {}
+        static inline void Site (const void *, RwSpinLockMode, const RwSpinLockSite &) noexcept {}
+        static inline DWORD Owner (const void *) noexcept { return 0; }
+    };
+
+    // RwSpinLockYieldHook
+    //  - per-thread hook for user-mode schedulers that multiplex fibers or green threads onto few OS threads
+    //  - blocking the OS thread in SwitchToThread or Sleep would also block the fiber holding the lock,
+    //    so when set, the hook is called instead, to switch to other runnable fiber
+    //  - the hook receives the back-off 'phase' it replaces, and may block the thread itself if there's
+    //    no other fiber to run; YieldProcessor phase is never replaced
+    //  - the hook must return back to the waiting fiber eventually, and must not throw, thus is noexcept
+    //  - reference scheduler: Test/Linux/Fibers.cpp, Win32 fibers version in README
+    //
+    class RwSpinLockYieldHook {
+    public:
+        using Function = void (*) (void * context, RwSpinLockPhase phase) noexcept;
+
+        // Set
+        //  - installs 'function' for the calling thread, nullptr restores default behavior
+        //
+        static inline void Set (Function function, void * context = nullptr) noexcept {
+            RwSpinLockYieldHook::function = function;
+            RwSpinLockYieldHook::context = context;
+        }
+
+        // Yield
+        //  - calls the hook, if any, returns false if there's no hook and the caller should block the thread
+        //
+        static inline bool Yield (RwSpinLockPhase phase) noexcept {
+            if (auto f = RwSpinLockYieldHook::function) {
+                f (RwSpinLockYieldHook::context, phase);
+                return true;
+            } else
+                return false;
+        }
+
+    private:
+        static inline thread_local Function function = nullptr;
+        static inline thread_local void * context = nullptr;
+    };
+
+    // RwSpinLockEnvironment
+    //  - selects spinning schedule for all RwSpinLocks in the process
+    //  - spinning tuned on bare metal hurts on VMs with vCPU overcommit, where the lock holder's vCPU
+    //    may be descheduled by the hypervisor, and every spin round is then wasted
+    //
+    class RwSpinLockEnvironment {
+    public:
+        enum Type : long {
+            Automatic = 0,  // detect on first contention
+            BareMetal,      // physical hardware, or VM with dedicated vCPUs
+            Virtualized,    // shared vCPUs, spin less and proceed to Sleep (1) much sooner
+        };
+
+        // Override
+        //  - manual override of the detected environment, Automatic re-enables detection
+        //  - takes effect immediately for all waiting threads
+        //
+        static inline void Override (Type environment) noexcept {
+            InterlockedExchange (&RwSpinLockEnvironment::current, environment);
+        }
+
+        // Get
+        //  - returns current environment, performs detection if not yet done
+        //
+        static inline Type Get () noexcept {
+            auto environment = static_cast <Type> (RwSpinLockEnvironment::current);
+            if (environment == Automatic) {
+                environment = RwSpinLockEnvironment::Detect ();
+                InterlockedCompareExchange (&RwSpinLockEnvironment::current, environment, Automatic);
+            }
+            return environment;
+        }
+
+        // Detect
+        //  - CPUID hypervisor present bit, then paravirt hints of known hypervisors:
+        //     - KVM - KVM_HINTS_REALTIME reports vCPUs pinned to dedicated pCPUs, spinning as on bare metal is fine
+        //     - Hyper-V - recommended spinlock retry count of 0xFFFFFFFF means the hypervisor never wants
+        //                 to be notified of long spins, i.e. vCPUs are not overcommitted (or root partition)
+        //  - any other hypervisor is presumed to overcommit
+        //
+        static inline Type Detect () noexcept;
+
+    private:
+        static inline volatile long current = Automatic;
+    };
+
+    // RwSpinLockAdmission
+    //  - Malthusian admission control, culls excess spinners
+    //  - when enabled, at most 'limit' threads per lock actively spin, the surplus is sent to passive set,
+    //    where threads don't touch the lock and only check once per Sleep (1) whether they can become active
+    //  - active spinner that fails to acquire the lock in 'period' rounds yields its place to a passive one,
+    //    rotating the sets for long-term fairness
+    //  - passive waiters always park in Sleep (1), don't escalate, and touch the lock only with plain read,
+    //    attempting to acquire it only when it looks free
+    //  - spinners are counted per process, in a fixed table of 64 slots indexed by hashed lock address, shared
+    //    by all locks: locks that hash into the same slot share the 'limit', so with many concurrently contended
+    //    locks fewer than 'limit' threads may spin on each; cross-process contenders are culled separately
+    //    in each process
+    //
+    class RwSpinLockAdmission {
+        struct Slot;
+
+    public:
+
+        // Enable
+        //  - limit - maximum number of actively spinning threads per lock, 0 disables admission control (default)
+        //  - period - number of rounds after which an active spinner yields its place to a passive waiter
+        //
+        static inline void Enable (long limit, long period = 512) noexcept {
+            InterlockedExchange (&RwSpinLockAdmission::period, period);
+            InterlockedExchange (&RwSpinLockAdmission::limit, limit);
+        }
+
+        // Disable
+        //  - threads already in passive set get admitted on their next check
+        //
+        static inline void Disable () noexcept {
+            InterlockedExchange (&RwSpinLockAdmission::limit, 0);
+        }
+
+        // Ticket
+        //  - membership of a single waiting thread in active or passive set of a lock
+        //
+        class Ticket {
+            Slot * slot = nullptr;
+            enum : long { None, Active, Passive } status = None;
+            long rounds = 0;
+
+        public:
+            inline Ticket () noexcept = default;
+            inline ~Ticket () noexcept;
+
+            // Admit
+            //  - called every round, returns true if the thread may spin, false if it should park
+            //  - thread that rotated out to the passive set skips its next check
+            //
+            inline bool Admit (const void * lock) noexcept;
+
+            // IsPassive
+            //  - true while the thread is in the passive set
+            //
+            inline bool IsPassive () const noexcept {
+                return this->status == Passive;
+            }
+
+            Ticket (const Ticket &) = delete;
+            Ticket & operator = (const Ticket &) = delete;
+        };
+
+    private:
+        struct alignas (64) Slot {
+            volatile long active;
+            volatile long passive;
+        };
+
+        static inline Slot slots [64] = {};
+        static inline volatile long limit = 0;
+        static inline volatile long period = 512;
+    };
 
     // RwSpinLock
     //  - slim, cross-process, reader-writer spin lock implementation
     //  - unfair locking, writers don't have priority and can be starved
     //  - StateType - underlying interlocked counter variable
     //     - supported: 'short', 'long' or 'long long'
+    //  - Stats - compile-time statistics policy, see RwSpinLockNoStatistics (default) and RwSpinLockStatistics
     //
-    template <typename StateType = short>
+    template <typename StateType = short, typename Stats = RwSpinLockNoStatistics>
     class RwSpinLock {
 
         // state
@@ -29,33 +295,64 @@ namespace Windows {
         StateType state = 0;
 
     private:
+        template <std::size_t Slots> friend class RwSpinLockPerCpu; // shares the back-off schedule
+
         static constexpr StateType ExclusivelyOwned = -1;
         struct Parameters { // NOTE: might need additional tuning
             struct Exclusive {
                 static constexpr auto Yields = 125u;
                 static constexpr auto Sleep0s = 2u;
+
+                struct Virtualized {
+                    static constexpr auto Yields = 24u;
+                    static constexpr auto Sleep0s = 1u;
+                };
             };
             struct Shared {
                 static constexpr auto Yields = 120u;
                 static constexpr auto Sleep0s = 7u;
+
+                struct Virtualized {
+                    static constexpr auto Yields = 24u;
+                    static constexpr auto Sleep0s = 2u;
+                };
             };
             struct Upgrade {
                 static constexpr auto Yields = 27u;
                 static constexpr auto Sleep0s = 100u;
+
+                struct Virtualized {
+                    static constexpr auto Yields = 8u;
+                    static constexpr auto Sleep0s = 16u;
+                };
             };
         };
 
     public:
 
         // C++ style "smart" if-scope operations
+        //  - 'site' is reported to Stats policy, leave default to capture caller's source location
+
+        [[nodiscard]] inline RwSpinLockScopeExclusive <StateType, Stats> exclusively (std::uint32_t * rounds = nullptr, RwSpinLockSite site = RwSpinLockSite::Current ()) noexcept;
+        [[nodiscard]] inline RwSpinLockScopeExclusive <StateType, Stats> exclusively (std::uint64_t timeout, std::uint32_t * rounds = nullptr, RwSpinLockSite site = RwSpinLockSite::Current ()) noexcept;
+        [[nodiscard]] inline RwSpinLockScopeExclusive <StateType, Stats> exclusively (RwSpinLockWaitProfile & profile, RwSpinLockSite site = RwSpinLockSite::Current ()) noexcept;
+        [[nodiscard]] inline RwSpinLockScopeExclusive <StateType, Stats> exclusively (std::uint64_t timeout, RwSpinLockWaitProfile & profile, RwSpinLockSite site = RwSpinLockSite::Current ()) noexcept;
 
-        [[nodiscard]] inline RwSpinLockScopeExclusive <StateType> exclusively (std::uint32_t * rounds = nullptr) noexcept;
-        [[nodiscard]] inline RwSpinLockScopeExclusive <StateType> exclusively (std::uint64_t timeout, std::uint32_t * rounds = nullptr) noexcept;
+        [[nodiscard]] inline RwSpinLockScopeShared <StateType, Stats> share (std::uint32_t * rounds = nullptr, RwSpinLockSite site = RwSpinLockSite::Current ()) noexcept;
+        [[nodiscard]] inline RwSpinLockScopeShared <StateType, Stats> share (std::uint64_t timeout, std::uint32_t * rounds = nullptr, RwSpinLockSite site = RwSpinLockSite::Current ()) noexcept;
+        [[nodiscard]] inline RwSpinLockScopeShared <StateType, Stats> share (RwSpinLockWaitProfile & profile, RwSpinLockSite site = RwSpinLockSite::Current ()) noexcept;
+        [[nodiscard]] inline RwSpinLockScopeShared <StateType, Stats> share (std::uint64_t timeout, RwSpinLockWaitProfile & profile, RwSpinLockSite site = RwSpinLockSite::Current ()) noexcept;
 
-        [[nodiscard]] inline RwSpinLockScopeShared <StateType> share (std::uint32_t * rounds = nullptr) noexcept;
-        [[nodiscard]] inline RwSpinLockScopeShared <StateType> share (std::uint64_t timeout, std::uint32_t * rounds = nullptr) noexcept;
+        // try_exclusively/try_share
+        //  - single attempt to lock, without any spinning, returns scope guard that evaluates to false on failure
+        //  - rounds - reported to Stats policy, see TryAcquireExclusive
+        //
+        [[nodiscard]] inline RwSpinLockScopeExclusive <StateType, Stats> try_exclusively (std::uint32_t rounds = 0) noexcept;
+        [[nodiscard]] inline RwSpinLockScopeShared <StateType, Stats> try_share (std::uint32_t rounds = 0) noexcept;
 
     public:
+        using WaitProfile = RwSpinLockWaitProfile;
+        using AcquireResult = RwSpinLockAcquireResult;
 
         // simple locking pattern
 
@@ -71,25 +368,34 @@ namespace Windows {
 
         // TryAcquireExclusive
         //  - attempts to acquire exclusive/write lock, returns result
-        //
-        [[nodiscard]] inline bool TryAcquireExclusive () noexcept {
-            return this->state == 0
-                && this->LockedCompareExchange (&this->state, ExclusivelyOwned, 0) == 0;
+        //  - rounds - number of unsuccessful attempts the caller already made itself, when retrying in its own loop
+        //             (e.g. asynchronous acquisition), reported to Stats policy on success
+        //
+        [[nodiscard]] inline bool TryAcquireExclusive (std::uint32_t rounds = 0) noexcept {
+            if (this->AttemptExclusive ()) {
+                Stats::Acquired (this, RwSpinLockMode::Exclusive, rounds);
+                return true;
+            } else
+                return false;
         }
 
         // TryAcquireShared
         //  - attempts to acquire shared/read lock, returns result
-        //
-        [[nodiscard]] inline bool TryAcquireShared () noexcept {
-            auto s = *static_cast <volatile StateType *> (&this->state); // ReadNoFence
-            return s != ExclusivelyOwned
-                && this->LockedCompareExchange (&this->state, s + 1, s) == s;
+        //  - rounds - see TryAcquireExclusive
+        //
+        [[nodiscard]] inline bool TryAcquireShared (std::uint32_t rounds = 0) noexcept {
+            if (this->AttemptShared ()) {
+                Stats::Acquired (this, RwSpinLockMode::Shared, rounds);
+                return true;
+            } else
+                return false;
         }
 
         // ReleaseExclusive
         //  - releases all and any locks
         //
         inline void ReleaseExclusive () noexcept {
+            Stats::Released (this, RwSpinLockMode::Exclusive);
             this->LockedExchange (&this->state, 0);
         }
 
@@ -97,6 +403,7 @@ namespace Windows {
         //  - releases one shared/read lock
         //
         inline void ReleaseShared () noexcept {
+            Stats::Released (this, RwSpinLockMode::Shared);
             this->LockedDecrement (&this->state);
         }
 
@@ -106,12 +413,19 @@ namespace Windows {
         //  - the code spins while someone else owns it (not zero) or someone beat us setting it to ExclusivelyOwned in between
         //     - failing fence in interlocked exchange is allowed, first test is just performance optimization (bus locking)
         //     - also YieldProcessor (and all other calls) in Spin function is full memory barrier
+        //  - threads culled by RwSpinLockAdmission park in Sleep (1), 'rounds' include the parked rounds
+        //  - SwitchToThread and Sleep calls are replaced by RwSpinLockYieldHook, if set for the thread
         //  - version with timeout parameter returns true on success and false on timeout
+        //     - with AcquireResult it also reports lock state and owner on failure, see RwSpinLockAcquireResult
         //  - version without timeout parameter always succeeds or blocks forever (use ForceUnlock to recover)
+        //  - WaitProfile overloads report rounds and time spent in each phase, instead of total rounds
         //
         inline void AcquireExclusive (std::uint32_t * rounds = nullptr) noexcept;
+        inline void AcquireExclusive (WaitProfile & profile) noexcept;
 
         [[nodiscard]] inline bool AcquireExclusive (std::uint64_t timeout, std::uint32_t * rounds = nullptr) noexcept;
+        [[nodiscard]] inline bool AcquireExclusive (std::uint64_t timeout, WaitProfile & profile) noexcept;
+        [[nodiscard]] inline bool AcquireExclusive (std::uint64_t timeout, AcquireResult & result) noexcept;
 
         // AcquireShared
         //  - acquires the lock for read access (multiple threads in parallel, no writter is allowed)
@@ -121,8 +435,11 @@ namespace Windows {
         //  - version without timeout parameter always succeeds or blocks forever (use ForceUnlock to recover)
         //
         inline void AcquireShared (std::uint32_t * rounds = nullptr) noexcept;
+        inline void AcquireShared (WaitProfile & profile) noexcept;
 
         [[nodiscard]] inline bool AcquireShared (std::uint64_t timeout, std::uint32_t * rounds = nullptr) noexcept;
+        [[nodiscard]] inline bool AcquireShared (std::uint64_t timeout, WaitProfile & profile) noexcept;
+        [[nodiscard]] inline bool AcquireShared (std::uint64_t timeout, AcquireResult & result) noexcept;
 
         // ForceUnlock
         //  - use only if the thread/process holding the lock crashed and there is no other reader active
@@ -136,8 +453,13 @@ namespace Windows {
         //  - succeeds only if there are no simultaneous readers
         //
         [[nodiscard]] inline bool TryUpgradeToExclusive () noexcept {
-            return this->state == 1
-                && this->LockedCompareExchange (&this->state, ExclusivelyOwned, 1) == 1;
+            if (this->AttemptUpgrade ()) {
+                Stats::Acquired (this, RwSpinLockMode::Upgrade, 0);
+                return true;
+            } else {
+                Stats::UpgradeFailed (this);
+                return false;
+            }
         }
 
         // UpgradeToExclusive
@@ -145,12 +467,15 @@ namespace Windows {
         //  - call ONLY when holding SINGLE shared lock (after successfull AcquireShared/TryAcquireShared)
         //
         [[nodiscard]] inline bool UpgradeToExclusive (std::uint64_t timeout, std::uint32_t * rounds = nullptr) noexcept;
+        [[nodiscard]] inline bool UpgradeToExclusive (std::uint64_t timeout, WaitProfile & profile) noexcept;
+        [[nodiscard]] inline bool UpgradeToExclusive (std::uint64_t timeout, AcquireResult & result) noexcept;
 
         // DowngradeToShared
         //  - converts exclusive/writting lock to shared/reading (allow others to read, while continuing reading)
         //  - call ONLY when holding exclusive lock, then release using ReleaseShared
         //
         inline void DowngradeToShared () noexcept {
+            Stats::Released (this, RwSpinLockMode::Upgrade);
             this->LockedExchange (&this->state, 1);
         }
 
@@ -171,8 +496,71 @@ namespace Windows {
         }
 
     private:
+
+        // Attempt*
+        //  - single attempt, without reporting to Stats
+        //
+        inline bool AttemptExclusive () noexcept {
+            return this->state == 0
+                && this->LockedCompareExchange (&this->state, ExclusivelyOwned, 0) == 0;
+        }
+        inline bool AttemptShared () noexcept {
+            auto s = *static_cast <volatile StateType *> (&this->state); // ReadNoFence
+            return s != ExclusivelyOwned
+                && this->LockedCompareExchange (&this->state, s + 1, s) == s;
+        }
+        inline bool AttemptUpgrade () noexcept {
+            return this->state == 1
+                && this->LockedCompareExchange (&this->state, ExclusivelyOwned, 1) == 1;
+        }
+
+        // Available
+        //  - whether Attempt* of 'Mode' would currently find the lock free, plain read without interlocked operation
+        //  - for passive waiters, culled by admission control: shared is available while readers hold the lock
+        //
+        template <RwSpinLockMode Mode>
+        inline bool Available () const noexcept {
+            auto s = *static_cast <const volatile StateType *> (&this->state); // ReadNoFence
+            if constexpr (Mode == RwSpinLockMode::Shared)
+                return s != ExclusivelyOwned;
+            else
+            if constexpr (Mode == RwSpinLockMode::Upgrade)
+                return s == 1; // only our own shared ownership left
+            else
+                return s == 0;
+        }
+
+        template <typename Timings, RwSpinLockMode Mode, bool (RwSpinLock::*Attempt) () noexcept>
+        inline bool Wait (const std::uint64_t * timeout, std::uint32_t * rounds, WaitProfile * profile = nullptr, AcquireResult * result = nullptr) noexcept;
+
+        // Ticks/Nanoseconds
+        //  - QueryPerformanceCounter, for measuring phases of the wait
+        //
+        static inline std::uint64_t Ticks () noexcept {
+            LARGE_INTEGER t;
+            QueryPerformanceCounter (&t);
+            return t.QuadPart;
+        }
+        static inline std::uint64_t Nanoseconds (std::uint64_t ticks) noexcept;
+
+        // Escalate/Spin
+        //  - Escalate returns back-off phase of 'round' past the YieldProcessor phase, Spin performs it
+        //
+        template <typename Timings>
+        static inline RwSpinLockPhase Escalate (std::uint32_t round) noexcept;
+        static inline void Spin (RwSpinLockPhase phase) noexcept;
+
+        // Yields/Sleep0s
+        //  - number of YieldProcessor and Sleep (0) rounds for current RwSpinLockEnvironment
+        //
         template <typename Timings>
-        inline void Spin (std::uint32_t round);
+        static inline std::uint32_t Yields () noexcept {
+            return (RwSpinLockEnvironment::Get () == RwSpinLockEnvironment::Virtualized) ? Timings::Virtualized::Yields : Timings::Yields;
+        }
+        template <typename Timings>
+        static inline std::uint32_t Sleep0s () noexcept {
+            return (RwSpinLockEnvironment::Get () == RwSpinLockEnvironment::Virtualized) ? Timings::Virtualized::Sleep0s : Timings::Sleep0s;
+        }
 
         inline long long LockedCompareExchange (volatile long long * dst, long long x, long long cmp) noexcept { return InterlockedCompareExchange64 (dst, x, cmp); }
         inline     short LockedCompareExchange (volatile     short * dst,     short x,     short cmp) noexcept { return InterlockedCompareExchange16 (dst, x, cmp); }
@@ -190,12 +578,12 @@ namespace Windows {
     // RwSpinLockScopeExclusive
     //  - unlocks exclusive lock acquired through RwSpinLock::exclusively
     //
-    template <typename StateType>
+    template <typename StateType, typename Stats>
     class RwSpinLockScopeExclusive {
-        friend class RwSpinLock <StateType>;
-        RwSpinLock <StateType> * lock;
+        friend class RwSpinLock <StateType, Stats>;
+        RwSpinLock <StateType, Stats> * lock;
 
-        inline RwSpinLockScopeExclusive (RwSpinLock <StateType> * lock) noexcept : lock (lock) {};
+        inline RwSpinLockScopeExclusive (RwSpinLock <StateType, Stats> * lock) noexcept : lock (lock) {};
 
     public:
 
@@ -219,7 +607,7 @@ namespace Windows {
         //  - the destructor of the returned scope object restores the exclusive lock and optionally writes 'round'
         //  - NOTE: 'rounds' is set AFTER the scope guard goes out of scope
         //
-        [[nodiscard]] inline RwSpinLockScopeExclusiveUnlocked <StateType> temporarily_unlock (std::uint32_t * rounds = nullptr) noexcept;
+        [[nodiscard]] inline RwSpinLockScopeExclusiveUnlocked <StateType, Stats> temporarily_unlock (std::uint32_t * rounds = nullptr) noexcept;
 
         // operator bool
         //  - returns whether the exclusive lock is still active
@@ -240,12 +628,13 @@ namespace Windows {
     // RwSpinLockScopeUpgraded
     //  - downgrades exclusive lock acquired through RwSpinLock::upgrade
     //
-    template <typename StateType>
+    template <typename StateType, typename Stats>
     class RwSpinLockScopeUpgraded {
-        friend class RwSpinLock <StateType>;
-        RwSpinLock <StateType> * lock;
+        friend class RwSpinLock <StateType, Stats>;
+        friend class RwSpinLockScopeShared <StateType, Stats>;
+        RwSpinLock <StateType, Stats> * lock;
 
-        inline RwSpinLockScopeUpgraded (RwSpinLock <StateType> * lock) noexcept : lock (lock) {};
+        inline RwSpinLockScopeUpgraded (RwSpinLock <StateType, Stats> * lock) noexcept : lock (lock) {};
 
     public:
 
@@ -269,7 +658,7 @@ namespace Windows {
         //  - the destructor of the returned scope object restores the exclusive lock and optionally writes 'round'
         //  - NOTE: 'rounds' is set AFTER the scope guard goes out of scope
         //
-        [[nodiscard]] inline RwSpinLockScopeExclusiveUnlocked <StateType> temporarily_unlock (std::uint32_t * rounds = nullptr) noexcept;
+        [[nodiscard]] inline RwSpinLockScopeExclusiveUnlocked <StateType, Stats> temporarily_unlock (std::uint32_t * rounds = nullptr) noexcept;
 
         // operator bool
         //  - returns whether the upgraded exclusive lock is still active
@@ -290,12 +679,12 @@ namespace Windows {
     // RwSpinLockScopeShared
     //  - unlocks shared lock acquired through RwSpinLock::shared
     //
-    template <typename StateType>
+    template <typename StateType, typename Stats>
     class RwSpinLockScopeShared {
-        friend class RwSpinLock <StateType>;
-        RwSpinLock <StateType> * lock;
+        friend class RwSpinLock <StateType, Stats>;
+        RwSpinLock <StateType, Stats> * lock;
 
-        inline RwSpinLockScopeShared (RwSpinLock <StateType> * lock) noexcept : lock (lock) {};
+        inline RwSpinLockScopeShared (RwSpinLock <StateType, Stats> * lock) noexcept : lock (lock) {};
 
     public:
 
@@ -317,8 +706,8 @@ namespace Windows {
         //  - introduces a scope (C++ style "smart" if-scope pattern) where the shared lock is upgraded to exclusive
         //  - NOTE: both of these functions are likely to fail, and the failure must be handled properly (see REAMDE.md)
         //
-        [[nodiscard]] inline RwSpinLockScopeUpgraded <StateType> upgrade (std::uint32_t * rounds = nullptr) noexcept;
-        [[nodiscard]] inline RwSpinLockScopeUpgraded <StateType> upgrade (std::uint64_t timeout, std::uint32_t * rounds = nullptr) noexcept;
+        [[nodiscard]] inline RwSpinLockScopeUpgraded <StateType, Stats> upgrade (std::uint32_t * rounds = nullptr, RwSpinLockSite site = RwSpinLockSite::Current ()) noexcept;
+        [[nodiscard]] inline RwSpinLockScopeUpgraded <StateType, Stats> upgrade (std::uint64_t timeout, std::uint32_t * rounds = nullptr, RwSpinLockSite site = RwSpinLockSite::Current ()) noexcept;
 
         // release
         //  - to manually release the exclusive lock before going out of scope
@@ -331,7 +720,7 @@ namespace Windows {
         //  - the destructor of the returned scope object re-locks for shared access and optionally writes 'round'
         //  - NOTE: 'rounds' is set AFTER the scope guard goes out of scope
         //
-        [[nodiscard]] inline RwSpinLockScopeSharedUnlocked <StateType> temporarily_unlock (std::uint32_t * rounds = nullptr) noexcept;
+        [[nodiscard]] inline RwSpinLockScopeSharedUnlocked <StateType, Stats> temporarily_unlock (std::uint32_t * rounds = nullptr) noexcept;
 
         // operator bool
         //  - returns whether the lock is still active
@@ -352,14 +741,15 @@ namespace Windows {
     // RwSpinLockScopeExclusiveUnlocked
     //  - scope guard for temporarily-unlocked scope inside of exclusively-locked scope
     //
-    template <typename StateType>
+    template <typename StateType, typename Stats>
     class RwSpinLockScopeExclusiveUnlocked {
-        friend class RwSpinLock <StateType>;
+        friend class RwSpinLockScopeExclusive <StateType, Stats>;
+        friend class RwSpinLockScopeUpgraded <StateType, Stats>;
 
-        RwSpinLock <StateType> * lock;
+        RwSpinLock <StateType, Stats> * lock;
         std::uint32_t * rounds;
 
-        inline RwSpinLockScopeExclusiveUnlocked (RwSpinLock <StateType> * lock, std::uint32_t * rounds) noexcept : lock (lock), rounds (rounds) {};
+        inline RwSpinLockScopeExclusiveUnlocked (RwSpinLock <StateType, Stats> * lock, std::uint32_t * rounds) noexcept : lock (lock), rounds (rounds) {};
 
     public:
 
@@ -395,14 +785,14 @@ namespace Windows {
     // RwSpinLockScopeSharedUnlocked
     //  - scope guard for temporarily-unlocked scope inside of shared-locked scope
     //
-    template <typename StateType>
+    template <typename StateType, typename Stats>
     class RwSpinLockScopeSharedUnlocked {
-        friend class RwSpinLock <StateType>;
+        friend class RwSpinLockScopeShared <StateType, Stats>;
 
-        RwSpinLock <StateType> * lock;
+        RwSpinLock <StateType, Stats> * lock;
         std::uint32_t * rounds;
 
-        inline RwSpinLockScopeSharedUnlocked (RwSpinLock <StateType> * lock, std::uint32_t * rounds) noexcept : lock (lock), rounds (rounds) {};
+        inline RwSpinLockScopeSharedUnlocked (RwSpinLock <StateType, Stats> * lock, std::uint32_t * rounds) noexcept : lock (lock), rounds (rounds) {};
 
     public:
 
@@ -5,41 +5,41 @@
 
 // RwSpinLockScopeExclusive
 
-template <typename StateType>
-inline Windows::RwSpinLockScopeExclusive <StateType>::~RwSpinLockScopeExclusive () noexcept {
+template <typename StateType, typename Stats>
+inline Windows::RwSpinLockScopeExclusive <StateType, Stats>::~RwSpinLockScopeExclusive () noexcept {
     if (this->lock) {
         this->release ();
     }
 }
 
-template <typename StateType>
-inline void Windows::RwSpinLockScopeExclusive <StateType>::release () noexcept {
+template <typename StateType, typename Stats>
+inline void Windows::RwSpinLockScopeExclusive <StateType, Stats>::release () noexcept {
     this->lock->ReleaseExclusive ();
     this->lock = nullptr;
 }
 
 // RwSpinLockScopeUpgraded
 
-template <typename StateType>
-inline Windows::RwSpinLockScopeUpgraded <StateType>::~RwSpinLockScopeUpgraded () noexcept {
+template <typename StateType, typename Stats>
+inline Windows::RwSpinLockScopeUpgraded <StateType, Stats>::~RwSpinLockScopeUpgraded () noexcept {
     if (this->lock) {
         this->release ();
     }
 }
 
-template <typename StateType>
-inline void Windows::RwSpinLockScopeUpgraded <StateType>::release () noexcept {
+template <typename StateType, typename Stats>
+inline void Windows::RwSpinLockScopeUpgraded <StateType, Stats>::release () noexcept {
     this->lock->DowngradeToShared ();
     this->lock = nullptr;
 }
 
 // RwSpinLockScopeShared
 
-template <typename StateType>
-inline Windows::RwSpinLockScopeShared <StateType>::RwSpinLockScopeShared (const Windows::RwSpinLockScopeShared <StateType> & from) noexcept : lock (from.lock) { this->lock->AcquireShared (); }
+template <typename StateType, typename Stats>
+inline Windows::RwSpinLockScopeShared <StateType, Stats>::RwSpinLockScopeShared (const Windows::RwSpinLockScopeShared <StateType, Stats> & from) noexcept : lock (from.lock) { this->lock->AcquireShared (); }
 
-template <typename StateType>
-inline Windows::RwSpinLockScopeShared <StateType> & Windows::RwSpinLockScopeShared <StateType>::operator = (const Windows::RwSpinLockScopeShared <StateType> & from) noexcept {
+template <typename StateType, typename Stats>
+inline Windows::RwSpinLockScopeShared <StateType, Stats> & Windows::RwSpinLockScopeShared <StateType, Stats>::operator = (const Windows::RwSpinLockScopeShared <StateType, Stats> & from) noexcept {
     if (this->lock) {
         this->release ();
     }
@@ -50,232 +50,449 @@ inline Windows::RwSpinLockScopeShared <StateType> & Windows::RwSpinLockScopeShar
     return *this;
 }
 
-template <typename StateType>
-inline Windows::RwSpinLockScopeShared <StateType>::~RwSpinLockScopeShared () noexcept {
+template <typename StateType, typename Stats>
+inline Windows::RwSpinLockScopeShared <StateType, Stats>::~RwSpinLockScopeShared () noexcept {
     if (this->lock) {
         this->release ();
     }
 }
 
-template <typename StateType>
-inline void Windows::RwSpinLockScopeShared <StateType>::release () noexcept {
+template <typename StateType, typename Stats>
+inline void Windows::RwSpinLockScopeShared <StateType, Stats>::release () noexcept {
     this->lock->ReleaseShared ();
     this->lock = nullptr;
 }
 
 // RwSpinLock
 
-template <typename StateType>
-inline void Windows::RwSpinLock <StateType>::AcquireExclusive (std::uint32_t * rounds) noexcept {
-    std::uint32_t r = 0;
-    while (!this->TryAcquireExclusive ()) {
-        if (++r <= Parameters::Exclusive::Yields) {
-            YieldProcessor ();
-        } else {
-            this->Spin <Parameters::Exclusive> (r);
-        }
-    }
-    if (rounds) {
-        *rounds = r;
-    }
+template <typename StateType, typename Stats>
+inline void Windows::RwSpinLock <StateType, Stats>::AcquireExclusive (std::uint32_t * rounds) noexcept {
+    this->template Wait <typename Parameters::Exclusive, RwSpinLockMode::Exclusive, &RwSpinLock::AttemptExclusive> (nullptr, rounds);
 }
 
-template <typename StateType>
-inline void Windows::RwSpinLock <StateType>::AcquireShared (std::uint32_t * rounds) noexcept {
-    std::uint32_t r = 0;
-    while (!this->TryAcquireShared ()) {
-        if (++r <= Parameters::Shared::Yields) {
-            YieldProcessor ();
-        } else {
-            this->Spin <Parameters::Shared> (r);
-        }
-    }
-    if (rounds) {
-        *rounds = r;
-    }
+template <typename StateType, typename Stats>
+inline void Windows::RwSpinLock <StateType, Stats>::AcquireExclusive (WaitProfile & profile) noexcept {
+    this->template Wait <typename Parameters::Exclusive, RwSpinLockMode::Exclusive, &RwSpinLock::AttemptExclusive> (nullptr, nullptr, &profile);
+}
+
+template <typename StateType, typename Stats>
+inline void Windows::RwSpinLock <StateType, Stats>::AcquireShared (std::uint32_t * rounds) noexcept {
+    this->template Wait <typename Parameters::Shared, RwSpinLockMode::Shared, &RwSpinLock::AttemptShared> (nullptr, rounds);
+}
+
+template <typename StateType, typename Stats>
+inline void Windows::RwSpinLock <StateType, Stats>::AcquireShared (WaitProfile & profile) noexcept {
+    this->template Wait <typename Parameters::Shared, RwSpinLockMode::Shared, &RwSpinLock::AttemptShared> (nullptr, nullptr, &profile);
+}
+
+template <typename StateType, typename Stats>
+[[nodiscard]] inline bool Windows::RwSpinLock <StateType, Stats>::AcquireExclusive (std::uint64_t timeout, std::uint32_t * rounds) noexcept {
+    return this->template Wait <typename Parameters::Exclusive, RwSpinLockMode::Exclusive, &RwSpinLock::AttemptExclusive> (&timeout, rounds);
+}
+
+template <typename StateType, typename Stats>
+[[nodiscard]] inline bool Windows::RwSpinLock <StateType, Stats>::AcquireShared (std::uint64_t timeout, std::uint32_t * rounds) noexcept {
+    return this->template Wait <typename Parameters::Shared, RwSpinLockMode::Shared, &RwSpinLock::AttemptShared> (&timeout, rounds);
+}
+
+template <typename StateType, typename Stats>
+[[nodiscard]] inline bool Windows::RwSpinLock <StateType, Stats>::UpgradeToExclusive (std::uint64_t timeout, std::uint32_t * rounds) noexcept {
+    return this->template Wait <typename Parameters::Upgrade, RwSpinLockMode::Upgrade, &RwSpinLock::AttemptUpgrade> (&timeout, rounds);
+}
+
+template <typename StateType, typename Stats>
+[[nodiscard]] inline bool Windows::RwSpinLock <StateType, Stats>::AcquireExclusive (std::uint64_t timeout, WaitProfile & profile) noexcept {
+    return this->template Wait <typename Parameters::Exclusive, RwSpinLockMode::Exclusive, &RwSpinLock::AttemptExclusive> (&timeout, nullptr, &profile);
+}
+
+template <typename StateType, typename Stats>
+[[nodiscard]] inline bool Windows::RwSpinLock <StateType, Stats>::AcquireExclusive (std::uint64_t timeout, AcquireResult & result) noexcept {
+    return this->template Wait <typename Parameters::Exclusive, RwSpinLockMode::Exclusive, &RwSpinLock::AttemptExclusive> (&timeout, nullptr, &result.profile, &result);
+}
+
+template <typename StateType, typename Stats>
+[[nodiscard]] inline bool Windows::RwSpinLock <StateType, Stats>::AcquireShared (std::uint64_t timeout, WaitProfile & profile) noexcept {
+    return this->template Wait <typename Parameters::Shared, RwSpinLockMode::Shared, &RwSpinLock::AttemptShared> (&timeout, nullptr, &profile);
+}
+
+template <typename StateType, typename Stats>
+[[nodiscard]] inline bool Windows::RwSpinLock <StateType, Stats>::AcquireShared (std::uint64_t timeout, AcquireResult & result) noexcept {
+    return this->template Wait <typename Parameters::Shared, RwSpinLockMode::Shared, &RwSpinLock::AttemptShared> (&timeout, nullptr, &result.profile, &result);
 }
 
-template <typename StateType>
-[[nodiscard]] inline bool Windows::RwSpinLock <StateType>::AcquireExclusive (std::uint64_t timeout, std::uint32_t * rounds) noexcept {
+template <typename StateType, typename Stats>
+[[nodiscard]] inline bool Windows::RwSpinLock <StateType, Stats>::UpgradeToExclusive (std::uint64_t timeout, WaitProfile & profile) noexcept {
+    return this->template Wait <typename Parameters::Upgrade, RwSpinLockMode::Upgrade, &RwSpinLock::AttemptUpgrade> (&timeout, nullptr, &profile);
+}
+
+template <typename StateType, typename Stats>
+[[nodiscard]] inline bool Windows::RwSpinLock <StateType, Stats>::UpgradeToExclusive (std::uint64_t timeout, AcquireResult & result) noexcept {
+    return this->template Wait <typename Parameters::Upgrade, RwSpinLockMode::Upgrade, &RwSpinLock::AttemptUpgrade> (&timeout, nullptr, &result.profile, &result);
+}
+
+// internals
+
+// Wait
+//  - common spinning loop of all Acquire* and UpgradeToExclusive calls
+//  - timeout - null for unlimited wait, otherwise after the YieldProcessor phase the thread yields
+//              with SwitchToThread and then continues spinning (with backoff) until the timeout elapses
+//  - profile - if not null, rounds of each phase are counted and timed, clock is read only on phase change
+//  - result - if not null, receives state of the lock and its owner on timeout, 'profile' must point into it
+//
+template <typename StateType, typename Stats>
+template <typename Timings, Windows::RwSpinLockMode Mode, bool (Windows::RwSpinLock <StateType, Stats>::*Attempt) () noexcept>
+inline bool Windows::RwSpinLock <StateType, Stats>::Wait (const std::uint64_t * timeout, std::uint32_t * rounds, WaitProfile * profile, AcquireResult * result) noexcept {
     std::uint32_t r = 0;
+    std::uint32_t parked = 0;
+    std::uint64_t t = 0;
+    std::uint64_t entered = 0;
+    RwSpinLockAdmission::Ticket admission;
+    RwSpinLockPhase phase = RwSpinLockPhase::Pause;
+
+    if (result) {
+        *result = {};
+    } else
+    if (profile) {
+        *profile = {};
+    }
 
-    while (!this->TryAcquireExclusive ()) {
-        if (++r <= Parameters::Exclusive::Yields) {
-            YieldProcessor ();
-        } else {
-            if (timeout) {
-                auto t = GetTickCount64 () + timeout;
-                SwitchToThread ();
-
-                // contested case, with backoff
-                while (!this->TryAcquireExclusive ()) {
-                    if (GetTickCount64 () < t) {
-                        this->Spin <Parameters::Exclusive> (++r);
-                    } else {
-                        if (rounds) {
-                            *rounds = r;
-                        }
-                        return false;
-                    }
+    // enter
+    //  - reports the next phase and accounts time spent in the previous one
+    //
+    auto enter = [this, profile, &phase, &entered] (RwSpinLockPhase next) noexcept {
+        if (profile) {
+            auto now = Ticks ();
+            if (entered) {
+                profile->elapsed [(int) phase] += now - entered;
+            }
+            entered = now;
+        }
+        Stats::Phase (this, Mode, phase = next);
+    };
+    auto leave = [profile, &phase, &entered] () noexcept {
+        if (profile && entered) {
+            profile->elapsed [(int) phase] += Ticks () - entered;
+            for (auto & elapsed : profile->elapsed) {
+                elapsed = Nanoseconds (elapsed);
+            }
+        }
+    };
+
+    // passive waiters, culled by admission control, don't attempt the interlocked operation,
+    // only check whether the lock looks available for 'Mode'
+
+    while (!((!admission.IsPassive () || this->template Available <Mode> ()) && (this->*Attempt) ())) {
+        const auto admitted = admission.Admit (this);
+        if (admitted) {
+            if (++r <= Yields <Timings> ()) {
+                if (r == 1 || phase != RwSpinLockPhase::Pause) { // first round, or re-admitted from Park
+                    enter (RwSpinLockPhase::Pause);
                 }
+                if (profile) {
+                    ++profile->count [(int) RwSpinLockPhase::Pause];
+                }
+                YieldProcessor ();
+                continue;
             }
-            break;
+            if (timeout && !t) {
+                t = GetTickCount64 () + *timeout;
+                enter (RwSpinLockPhase::Yield);
+                if (profile) {
+                    ++profile->count [(int) RwSpinLockPhase::Yield];
+                }
+                if (!RwSpinLockYieldHook::Yield (RwSpinLockPhase::Yield)) {
+                    SwitchToThread ();
+                }
+                continue;
+            }
+        } else {
+            ++parked;
+            if (timeout && !t) {
+                t = GetTickCount64 () + *timeout;
+            }
+        }
+
+        // contested case, with backoff
+        //  - the round is counted before the timeout check, so that profile Rounds match 'rounds' on timeout too
+
+        auto p = RwSpinLockPhase::Park; // culled, parked in passive set
+        if (admitted) {
+            p = Escalate <Timings> (r);
+        }
+        if (profile) {
+            ++profile->count [(int) p];
+        }
+
+        if (timeout && GetTickCount64 () >= t) {
+            if (rounds) {
+                *rounds = r + parked;
+            }
+            leave ();
+            if (result) {
+                result->state = this->state;
+                result->owner = (result->state == ExclusivelyOwned) ? Stats::Owner (this) : 0;
+            }
+            Stats::Timeout (this, Mode, r + parked);
+            return false;
+        }
+
+        if (phase != p) {
+            enter (p);
         }
+        Spin (p);
     }
     if (rounds) {
-        *rounds = r;
+        *rounds = r + parked;
     }
+    leave ();
+    Stats::Acquired (this, Mode, r + parked);
     return true;
 }
 
-template <typename StateType>
-[[nodiscard]] inline bool Windows::RwSpinLock <StateType>::AcquireShared (std::uint64_t timeout, std::uint32_t * rounds) noexcept {
-    std::uint32_t r = 0;
+template <typename StateType, typename Stats>
+inline std::uint64_t Windows::RwSpinLock <StateType, Stats>::Nanoseconds (std::uint64_t ticks) noexcept {
+    static const auto frequency = [] {
+        LARGE_INTEGER f;
+        QueryPerformanceFrequency (&f);
+        return f.QuadPart;
+    } ();
+    return ticks / frequency * 1000000000uLL + ticks % frequency * 1000000000uLL / frequency;
+}
 
-    while (!this->TryAcquireShared ()) {
-        if (++r <= Parameters::Shared::Yields) {
-            YieldProcessor ();
-        } else {
-            if (timeout) {
-                auto t = GetTickCount64 () + timeout;
-                SwitchToThread ();
-
-                // contested case, with backoff
-                while (!this->TryAcquireShared ()) {
-                    if (GetTickCount64 () < t) {
-                        this->Spin <Parameters::Shared> (++r);
-                    } else {
-                        if (rounds) {
-                            *rounds = r;
-                        }
-                        return false;
-                    }
-                }
-            }
-            break;
+template <typename StateType, typename Stats>
+template <typename Timings>
+inline Windows::RwSpinLockPhase Windows::RwSpinLock <StateType, Stats>::Escalate (std::uint32_t round) noexcept {
+    if (round > Yields <Timings> () + Sleep0s <Timings> ())
+        return RwSpinLockPhase::Sleep1;
+    else
+        return RwSpinLockPhase::Sleep0;
+}
+
+template <typename StateType, typename Stats>
+inline void Windows::RwSpinLock <StateType, Stats>::Spin (RwSpinLockPhase phase) noexcept {
+    if (!RwSpinLockYieldHook::Yield (phase)) {
+        Sleep ((phase == RwSpinLockPhase::Sleep0) ? 0 : 1);
+    }
+}
+
+// RwSpinLockEnvironment
+
+inline Windows::RwSpinLockEnvironment::Type Windows::RwSpinLockEnvironment::Detect () noexcept {
+#if defined (_M_IX86) || defined (_M_AMD64)
+    int r [4];
+    __cpuid (r, 1);
+    if (!(r [2] & (1 << 31)))
+        return BareMetal;
+
+    __cpuid (r, 0x40000000);
+    auto max = static_cast <unsigned int> (r [0]);
+    char vendor [13] = {};
+    std::memcpy (&vendor [0], &r [1], 4);
+    std::memcpy (&vendor [4], &r [2], 4);
+    std::memcpy (&vendor [8], &r [3], 4);
+
+    if (std::strcmp (vendor, "KVMKVMKVM") == 0) {
+        if (max >= 0x40000001) {
+            __cpuid (r, 0x40000001);
+            if (r [3] & (1 << 0)) // KVM_HINTS_REALTIME
+                return BareMetal;
         }
     }
-    if (rounds) {
-        *rounds = r;
+    if (std::strcmp (vendor, "Microsoft Hv") == 0) {
+        if (max >= 0x40000004) {
+            __cpuid (r, 0x40000004);
+            if (static_cast <unsigned int> (r [1]) == 0xFFFFFFFFu) // never notify about long spin waits
+                return BareMetal;
+        }
     }
-    return true;
+    return Virtualized;
+#else
+    return BareMetal;
+#endif
 }
 
-template <typename StateType>
-[[nodiscard]] inline bool Windows::RwSpinLock <StateType>::UpgradeToExclusive (std::uint64_t timeout, std::uint32_t * rounds) noexcept {
-    std::uint32_t r = 0;
+// RwSpinLockAdmission
 
-    while (!this->TryUpgradeToExclusive ()) {
-        if (++r <= Parameters::Upgrade::Yields) {
-            YieldProcessor ();
-        } else {
-            if (timeout) {
-                auto t = GetTickCount64 () + timeout;
-                SwitchToThread ();
-
-                // contested case, with backoff
-                while (!this->TryUpgradeToExclusive ()) {
-                    if (GetTickCount64 () < t) {
-                        this->Spin <Parameters::Upgrade> (++r);
-                    } else {
-                        if (rounds) {
-                            *rounds = r;
-                        }
-                        return false;
-                    }
+inline bool Windows::RwSpinLockAdmission::Ticket::Admit (const void * lock) noexcept {
+    const auto limit = RwSpinLockAdmission::limit;
+    switch (this->status) {
+        case None:
+            if (limit == 0)
+                return true;
+
+            this->slot = &RwSpinLockAdmission::slots [((std::uintptr_t) lock ^ ((std::uintptr_t) lock >> 6) ^ ((std::uintptr_t) lock >> 12)) % 64];
+            if (InterlockedIncrement (&this->slot->active) <= limit) {
+                this->status = Active;
+                return true;
+            }
+            InterlockedDecrement (&this->slot->active);
+            InterlockedIncrement (&this->slot->passive);
+            this->status = Passive;
+            return false;
+
+        case Active:
+            if (++this->rounds < RwSpinLockAdmission::period || this->slot->passive == 0)
+                return true;
+
+            // rotate, make place for one of the passive waiters
+            //  - the next check is skipped, so that the place goes to a waiter that parked earlier
+            InterlockedIncrement (&this->slot->passive);
+            InterlockedDecrement (&this->slot->active);
+            this->status = Passive;
+            this->rounds = -1;
+            return false;
+
+        case Passive:
+            if (this->rounds < 0 && limit != 0) {
+                ++this->rounds;
+                return false;
+            }
+            if (limit == 0 || this->slot->active < limit) {
+                if (InterlockedIncrement (&this->slot->active) <= limit || limit == 0) {
+                    InterlockedDecrement (&this->slot->passive);
+                    this->status = Active;
+                    return true;
                 }
+                InterlockedDecrement (&this->slot->active);
             }
-            break;
-        }
-    }
-    if (rounds) {
-        *rounds = r;
+            return false;
     }
     return true;
 }
 
-// internals
-
-template <typename StateType>
-template <typename Timings>
-inline void Windows::RwSpinLock <StateType>::Spin (std::uint32_t round) {
-    DWORD n = 0;
-    if (round > Timings::Yields + Timings::Sleep0s) {
-        n = 1;
+inline Windows::RwSpinLockAdmission::Ticket::~Ticket () noexcept {
+    switch (this->status) {
+        case Active:
+            InterlockedDecrement (&this->slot->active);
+            break;
+        case Passive:
+            InterlockedDecrement (&this->slot->passive);
+            break;
+        case None:
+            break;
     }
-    Sleep (n);
 }
 
 // if scope
 
-template <typename StateType>
-[[nodiscard]] inline Windows::RwSpinLockScopeExclusive <StateType> Windows::RwSpinLock <StateType>::exclusively (std::uint32_t * rounds) noexcept {
+template <typename StateType, typename Stats>
+[[nodiscard]] inline Windows::RwSpinLockScopeExclusive <StateType, Stats> Windows::RwSpinLock <StateType, Stats>::exclusively (std::uint32_t * rounds, RwSpinLockSite site) noexcept {
+    Stats::Site (this, RwSpinLockMode::Exclusive, site);
     this->AcquireExclusive (rounds);
     return this;
 }
-template <typename StateType>
-[[nodiscard]] inline Windows::RwSpinLockScopeExclusive <StateType> Windows::RwSpinLock <StateType>::exclusively (std::uint64_t timeout, std::uint32_t * rounds) noexcept {
+template <typename StateType, typename Stats>
+[[nodiscard]] inline Windows::RwSpinLockScopeExclusive <StateType, Stats> Windows::RwSpinLock <StateType, Stats>::exclusively (std::uint64_t timeout, std::uint32_t * rounds, RwSpinLockSite site) noexcept {
+    Stats::Site (this, RwSpinLockMode::Exclusive, site);
     if (this->AcquireExclusive (timeout, rounds))
         return this;
     else
         return nullptr;
 }
+template <typename StateType, typename Stats>
+[[nodiscard]] inline Windows::RwSpinLockScopeExclusive <StateType, Stats> Windows::RwSpinLock <StateType, Stats>::exclusively (RwSpinLockWaitProfile & profile, RwSpinLockSite site) noexcept {
+    Stats::Site (this, RwSpinLockMode::Exclusive, site);
+    this->AcquireExclusive (profile);
+    return this;
+}
+template <typename StateType, typename Stats>
+[[nodiscard]] inline Windows::RwSpinLockScopeExclusive <StateType, Stats> Windows::RwSpinLock <StateType, Stats>::exclusively (std::uint64_t timeout, RwSpinLockWaitProfile & profile, RwSpinLockSite site) noexcept {
+    Stats::Site (this, RwSpinLockMode::Exclusive, site);
+    if (this->AcquireExclusive (timeout, profile))
+        return this;
+    else
+        return nullptr;
+}
 
-template <typename StateType>
+template <typename StateType, typename Stats>
+[[nodiscard]] inline Windows::RwSpinLockScopeExclusive <StateType, Stats> Windows::RwSpinLock <StateType, Stats>::try_exclusively (std::uint32_t rounds) noexcept {
+    if (this->TryAcquireExclusive (rounds))
+        return this;
+    else
+        return nullptr;
+}
+
+template <typename StateType, typename Stats>
 [[nodiscard]] inline
-Windows::RwSpinLockScopeUpgraded <StateType>
-Windows::RwSpinLockScopeShared <StateType>::upgrade (std::uint32_t * rounds) noexcept {
-    if (this->TryUpgradeToExclusive ()) {
+Windows::RwSpinLockScopeUpgraded <StateType, Stats>
+Windows::RwSpinLockScopeShared <StateType, Stats>::upgrade (std::uint32_t * rounds, RwSpinLockSite site) noexcept {
+    Stats::Site (this->lock, RwSpinLockMode::Upgrade, site);
+    if (this->lock->TryUpgradeToExclusive ()) {
         if (rounds) {
             *rounds = 0;
         }
-        return this;
+        return this->lock;
     } else
         return nullptr;
 }
-template <typename StateType>
+template <typename StateType, typename Stats>
 [[nodiscard]] inline
-Windows::RwSpinLockScopeUpgraded <StateType>
-Windows::RwSpinLockScopeShared <StateType>::upgrade (std::uint64_t timeout, std::uint32_t * rounds) noexcept {
-    if (this->UpgradeToExclusive (timeout, rounds))
-        return this;
+Windows::RwSpinLockScopeUpgraded <StateType, Stats>
+Windows::RwSpinLockScopeShared <StateType, Stats>::upgrade (std::uint64_t timeout, std::uint32_t * rounds, RwSpinLockSite site) noexcept {
+    Stats::Site (this->lock, RwSpinLockMode::Upgrade, site);
+    if (this->lock->UpgradeToExclusive (timeout, rounds))
+        return this->lock;
     else
         return nullptr;
 }
 
-template <typename StateType>
-[[nodiscard]] inline Windows::RwSpinLockScopeShared <StateType> Windows::RwSpinLock <StateType>::share (std::uint32_t * rounds) noexcept {
+template <typename StateType, typename Stats>
+[[nodiscard]] inline Windows::RwSpinLockScopeShared <StateType, Stats> Windows::RwSpinLock <StateType, Stats>::share (std::uint32_t * rounds, RwSpinLockSite site) noexcept {
+    Stats::Site (this, RwSpinLockMode::Shared, site);
     this->AcquireShared (rounds);
     return this;
 }
-template <typename StateType>
-[[nodiscard]] inline Windows::RwSpinLockScopeShared <StateType> Windows::RwSpinLock <StateType>::share (std::uint64_t timeout, std::uint32_t * rounds) noexcept {
+template <typename StateType, typename Stats>
+[[nodiscard]] inline Windows::RwSpinLockScopeShared <StateType, Stats> Windows::RwSpinLock <StateType, Stats>::share (std::uint64_t timeout, std::uint32_t * rounds, RwSpinLockSite site) noexcept {
+    Stats::Site (this, RwSpinLockMode::Shared, site);
     if (this->AcquireShared (timeout, rounds))
         return this;
     else
         return nullptr;
 }
+template <typename StateType, typename Stats>
+[[nodiscard]] inline Windows::RwSpinLockScopeShared <StateType, Stats> Windows::RwSpinLock <StateType, Stats>::share (RwSpinLockWaitProfile & profile, RwSpinLockSite site) noexcept {
+    Stats::Site (this, RwSpinLockMode::Shared, site);
+    this->AcquireShared (profile);
+    return this;
+}
+template <typename StateType, typename Stats>
+[[nodiscard]] inline Windows::RwSpinLockScopeShared <StateType, Stats> Windows::RwSpinLock <StateType, Stats>::share (std::uint64_t timeout, RwSpinLockWaitProfile & profile, RwSpinLockSite site) noexcept {
+    Stats::Site (this, RwSpinLockMode::Shared, site);
+    if (this->AcquireShared (timeout, profile))
+        return this;
+    else
+        return nullptr;
+}
+
+template <typename StateType, typename Stats>
+[[nodiscard]] inline Windows::RwSpinLockScopeShared <StateType, Stats> Windows::RwSpinLock <StateType, Stats>::try_share (std::uint32_t rounds) noexcept {
+    if (this->TryAcquireShared (rounds))
+        return this;
+    else
+        return nullptr;
+}
 
 // RwSpinLockScopeExclusiveUnlocked
 
-template <typename StateType>
+template <typename StateType, typename Stats>
 [[nodiscard]] inline
-Windows::RwSpinLockScopeExclusiveUnlocked <StateType>
-Windows::RwSpinLockScopeExclusive <StateType>::temporarily_unlock (std::uint32_t * rounds) noexcept {
+Windows::RwSpinLockScopeExclusiveUnlocked <StateType, Stats>
+Windows::RwSpinLockScopeExclusive <StateType, Stats>::temporarily_unlock (std::uint32_t * rounds) noexcept {
     this->lock->ReleaseExclusive ();
     return { this->lock, rounds };
 }
 
-template <typename StateType>
+template <typename StateType, typename Stats>
 [[nodiscard]] inline
-Windows::RwSpinLockScopeExclusiveUnlocked <StateType>
-Windows::RwSpinLockScopeUpgraded <StateType>::temporarily_unlock (std::uint32_t * rounds) noexcept {
+Windows::RwSpinLockScopeExclusiveUnlocked <StateType, Stats>
+Windows::RwSpinLockScopeUpgraded <StateType, Stats>::temporarily_unlock (std::uint32_t * rounds) noexcept {
     this->lock->ReleaseExclusive ();
     return { this->lock, rounds };
 }
 
-template <typename StateType>
-inline Windows::RwSpinLockScopeExclusiveUnlocked <StateType>::RwSpinLockScopeExclusiveUnlocked (RwSpinLockScopeExclusiveUnlocked && from) noexcept
+template <typename StateType, typename Stats>
+inline Windows::RwSpinLockScopeExclusiveUnlocked <StateType, Stats>::RwSpinLockScopeExclusiveUnlocked (RwSpinLockScopeExclusiveUnlocked && from) noexcept
     : lock (from.lock)
     , rounds (from.rounds) {
 
@@ -283,40 +500,40 @@ inline Windows::RwSpinLockScopeExclusiveUnlocked <StateType>::RwSpinLockScopeExc
     from.rounds = nullptr;
 }
 
-template <typename StateType>
+template <typename StateType, typename Stats>
 inline
-Windows::RwSpinLockScopeExclusiveUnlocked <StateType> &
-Windows::RwSpinLockScopeExclusiveUnlocked <StateType>::operator = (RwSpinLockScopeExclusiveUnlocked && from) noexcept {
+Windows::RwSpinLockScopeExclusiveUnlocked <StateType, Stats> &
+Windows::RwSpinLockScopeExclusiveUnlocked <StateType, Stats>::operator = (RwSpinLockScopeExclusiveUnlocked && from) noexcept {
     std::swap (this->lock, from.lock);
     std::swap (this->rounds, from.rounds);
     return *this;
 }
 
-template <typename StateType>
-inline Windows::RwSpinLockScopeExclusiveUnlocked <StateType>::~RwSpinLockScopeExclusiveUnlocked () noexcept {
+template <typename StateType, typename Stats>
+inline Windows::RwSpinLockScopeExclusiveUnlocked <StateType, Stats>::~RwSpinLockScopeExclusiveUnlocked () noexcept {
     if (this->lock) {
         this->restore ();
     }
 }
 
-template <typename StateType>
-inline void Windows::RwSpinLockScopeExclusiveUnlocked <StateType>::restore () noexcept {
+template <typename StateType, typename Stats>
+inline void Windows::RwSpinLockScopeExclusiveUnlocked <StateType, Stats>::restore () noexcept {
     this->lock->AcquireExclusive (this->rounds);
     this->lock = nullptr;
 }
 
 // RwSpinLockScopeSharedUnlocked
 
-template <typename StateType>
+template <typename StateType, typename Stats>
 [[nodiscard]] inline
-Windows::RwSpinLockScopeSharedUnlocked <StateType>
-Windows::RwSpinLockScopeShared <StateType>::temporarily_unlock (std::uint32_t * rounds) noexcept {
+Windows::RwSpinLockScopeSharedUnlocked <StateType, Stats>
+Windows::RwSpinLockScopeShared <StateType, Stats>::temporarily_unlock (std::uint32_t * rounds) noexcept {
     this->lock->ReleaseShared ();
     return { this->lock, rounds };
 }
 
-template <typename StateType>
-inline Windows::RwSpinLockScopeSharedUnlocked <StateType>::RwSpinLockScopeSharedUnlocked (RwSpinLockScopeSharedUnlocked && from) noexcept
+template <typename StateType, typename Stats>
+inline Windows::RwSpinLockScopeSharedUnlocked <StateType, Stats>::RwSpinLockScopeSharedUnlocked (RwSpinLockScopeSharedUnlocked && from) noexcept
     : lock (from.lock)
     , rounds (from.rounds) {
 
@@ -324,24 +541,24 @@ inline Windows::RwSpinLockScopeSharedUnlocked <StateType>::RwSpinLockScopeShared
     from.rounds = nullptr;
 }
 
-template <typename StateType>
+template <typename StateType, typename Stats>
 inline
-Windows::RwSpinLockScopeSharedUnlocked <StateType> &
-Windows::RwSpinLockScopeSharedUnlocked <StateType>::operator = (RwSpinLockScopeSharedUnlocked && from) noexcept {
+Windows::RwSpinLockScopeSharedUnlocked <StateType, Stats> &
+Windows::RwSpinLockScopeSharedUnlocked <StateType, Stats>::operator = (RwSpinLockScopeSharedUnlocked && from) noexcept {
     std::swap (this->lock, from.lock);
     std::swap (this->rounds, from.rounds);
     return *this;
 }
 
-template <typename StateType>
-inline Windows::RwSpinLockScopeSharedUnlocked <StateType>::~RwSpinLockScopeSharedUnlocked () noexcept {
+template <typename StateType, typename Stats>
+inline Windows::RwSpinLockScopeSharedUnlocked <StateType, Stats>::~RwSpinLockScopeSharedUnlocked () noexcept {
     if (this->lock) {
         this->restore ();
     }
 }
 
-template <typename StateType>
-inline void Windows::RwSpinLockScopeSharedUnlocked <StateType>::restore () noexcept {
+template <typename StateType, typename Stats>
+inline void Windows::RwSpinLockScopeSharedUnlocked <StateType, Stats>::restore () noexcept {
     this->lock->AcquireShared (this->rounds);
     this->lock = nullptr;
 }
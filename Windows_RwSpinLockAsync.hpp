@@ -0,0 +1,93 @@
+#ifndef WINDOWS_RWSPINLOCKASYNC_HPP
+#define WINDOWS_RWSPINLOCKASYNC_HPP
+
+#include "Windows_RwSpinLock.hpp"
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Windows {
+
+    // async_exclusively/async_share
+    //  - acquires the lock without ever spinning or sleeping in the calling (event loop) thread
+    //  - if the lock is available, 'callback' is invoked immediately, from the calling thread
+    //  - otherwise the acquisition continues on the thread pool, see RwSpinLockAsyncWait,
+    //    and the 'callback' is invoked from a thread pool thread
+    //  - 'callback' receives the scope guard as rvalue, by moving it away it can keep the lock past its return,
+    //    otherwise the lock is released when the callback returns; the callback must not throw
+    //  - the lock may reside in shared memory, only the lock state is polled, no other process needs to cooperate
+    //  - the lock must outlive all pending asynchronous acquisitions
+    //  - environment - thread pool callback environment, default thread pool if NULL
+    //  - returns false if thread pool object could not be allocated, the callback is then NOT called
+    //
+    template <typename StateType, typename Stats, typename Callback>
+    [[nodiscard]] inline bool async_exclusively (RwSpinLock <StateType, Stats> & lock, Callback && callback, PTP_CALLBACK_ENVIRON environment = NULL) noexcept;
+
+    template <typename StateType, typename Stats, typename Callback>
+    [[nodiscard]] inline bool async_share (RwSpinLock <StateType, Stats> & lock, Callback && callback, PTP_CALLBACK_ENVIRON environment = NULL) noexcept;
+
+    // notify_exclusively/notify_share
+    //  - readiness notification for event loops waiting in WaitForMultipleObjects, MsgWaitForMultipleObjects,
+    //    alertable waits or thread pool waits, alongside sockets and other handles
+    //  - signals 'event' (SetEvent) once the lock is observed available for exclusive/shared access,
+    //    the loop then attempts try_exclusively/try_share, and if beaten by other thread, registers again
+    //  - one-shot, the event is signalled exactly once per successful call, immediately if the lock is available
+    //  - the event handle is duplicated, so the caller may close it any time
+    //  - cross-process: the lock may reside in shared memory, release in other process is observed by polling,
+    //    and the event may be named, or a handle duplicated from other process
+    //  - returns false if the handle couldn't be duplicated, or thread pool object allocated
+    //
+    template <typename StateType, typename Stats>
+    [[nodiscard]] inline bool notify_exclusively (RwSpinLock <StateType, Stats> & lock, HANDLE event, PTP_CALLBACK_ENVIRON environment = NULL) noexcept;
+
+    template <typename StateType, typename Stats>
+    [[nodiscard]] inline bool notify_share (RwSpinLock <StateType, Stats> & lock, HANDLE event, PTP_CALLBACK_ENVIRON environment = NULL) noexcept;
+
+    // RwSpinLockAsyncNotify
+    //  - common implementation of notify_exclusively and notify_share
+    //
+    template <typename StateType, typename Stats>
+    inline bool RwSpinLockAsyncNotify (RwSpinLock <StateType, Stats> & lock, HANDLE event, PTP_CALLBACK_ENVIRON environment, bool (*ready) (RwSpinLock <StateType, Stats> &, std::uint32_t) noexcept) noexcept;
+
+    // RwSpinLockAsyncWait
+    //  - state of single pending asynchronous acquisition or readiness notification
+    //  - attempt - function returning Guard that converts to 'true' on success, receives number of previous
+    //              unsuccessful attempts, which is reported to Stats policy as the rounds spent waiting
+    //  - follows the same back-off strategy as RwSpinLock, only instead of blocking the thread:
+    //     - YieldProcessor phase is limited to a few rounds in each thread pool callback
+    //     - Sleep (0) phase re-submits the callback to run again immediately, letting other work items run
+    //     - Sleep (1) phase re-arms the timer for 1 ms, which is rounded up to the system timer resolution
+    //
+    template <typename Lock, typename Guard, typename Callback>
+    class RwSpinLockAsyncWait {
+        struct Parameters { // NOTE: might need additional tuning
+            static constexpr auto Yields = 32u;
+            static constexpr auto Resubmits = 8u;
+        };
+
+        Lock * lock;
+        Guard (*attempt) (Lock &, std::uint32_t) noexcept;
+        Callback callback;
+        PTP_TIMER timer = NULL;
+        std::uint32_t round = 0;
+
+        template <typename C>
+        inline RwSpinLockAsyncWait (Lock * lock, Guard (*attempt) (Lock &, std::uint32_t) noexcept, C && callback)
+            : lock (lock)
+            , attempt (attempt)
+            , callback (std::forward <C> (callback)) {};
+
+        static inline VOID CALLBACK Retry (PTP_CALLBACK_INSTANCE, PVOID, PTP_TIMER) noexcept;
+
+    public:
+
+        // Start
+        //  - attempts the lock once, and if unsuccessful, schedules asynchronous retries
+        //
+        template <typename C>
+        static inline bool Start (Lock & lock, Guard (*attempt) (Lock &, std::uint32_t) noexcept, C && callback, PTP_CALLBACK_ENVIRON environment) noexcept;
+    };
+}
+
+#include "Windows_RwSpinLockAsync.tcc"
+#endif
@@ -0,0 +1,107 @@
+#ifndef WINDOWS_RWSPINLOCKASYNC_TCC
+#define WINDOWS_RWSPINLOCKASYNC_TCC
+
+#include "Windows_RwSpinLockAsync.hpp"
+
+template <typename StateType, typename Stats, typename Callback>
+[[nodiscard]] inline bool Windows::async_exclusively (RwSpinLock <StateType, Stats> & lock, Callback && callback, PTP_CALLBACK_ENVIRON environment) noexcept {
+    using Guard = RwSpinLockScopeExclusive <StateType, Stats>;
+    return RwSpinLockAsyncWait <RwSpinLock <StateType, Stats>, Guard, std::decay_t <Callback>>
+        ::Start (lock, [] (RwSpinLock <StateType, Stats> & lock, std::uint32_t rounds) noexcept { return lock.try_exclusively (rounds); },
+                 std::forward <Callback> (callback), environment);
+}
+
+template <typename StateType, typename Stats, typename Callback>
+[[nodiscard]] inline bool Windows::async_share (RwSpinLock <StateType, Stats> & lock, Callback && callback, PTP_CALLBACK_ENVIRON environment) noexcept {
+    using Guard = RwSpinLockScopeShared <StateType, Stats>;
+    return RwSpinLockAsyncWait <RwSpinLock <StateType, Stats>, Guard, std::decay_t <Callback>>
+        ::Start (lock, [] (RwSpinLock <StateType, Stats> & lock, std::uint32_t rounds) noexcept { return lock.try_share (rounds); },
+                 std::forward <Callback> (callback), environment);
+}
+
+template <typename StateType, typename Stats>
+[[nodiscard]] inline bool Windows::notify_exclusively (RwSpinLock <StateType, Stats> & lock, HANDLE event, PTP_CALLBACK_ENVIRON environment) noexcept {
+    return RwSpinLockAsyncNotify <StateType, Stats> (lock, event, environment,
+                                              [] (RwSpinLock <StateType, Stats> & lock, std::uint32_t) noexcept { return !lock.IsLocked (); });
+}
+
+template <typename StateType, typename Stats>
+[[nodiscard]] inline bool Windows::notify_share (RwSpinLock <StateType, Stats> & lock, HANDLE event, PTP_CALLBACK_ENVIRON environment) noexcept {
+    return RwSpinLockAsyncNotify <StateType, Stats> (lock, event, environment,
+                                              [] (RwSpinLock <StateType, Stats> & lock, std::uint32_t) noexcept { return !lock.IsLockedExclusively (); });
+}
+
+// RwSpinLockAsyncNotify
+//  - duplicates the event, so that it can be safely signalled even if the caller closes it
+//
+template <typename StateType, typename Stats>
+inline bool Windows::RwSpinLockAsyncNotify (RwSpinLock <StateType, Stats> & lock, HANDLE event, PTP_CALLBACK_ENVIRON environment, bool (*ready) (RwSpinLock <StateType, Stats> &, std::uint32_t) noexcept) noexcept {
+    HANDLE duplicate = NULL;
+    if (DuplicateHandle (GetCurrentProcess (), event, GetCurrentProcess (), &duplicate, 0, FALSE, DUPLICATE_SAME_ACCESS)) {
+
+        auto signal = [duplicate] (bool) noexcept {
+            SetEvent (duplicate);
+            CloseHandle (duplicate);
+        };
+        if (RwSpinLockAsyncWait <RwSpinLock <StateType, Stats>, bool, decltype (signal)>::Start (lock, ready, std::move (signal), environment))
+            return true;
+
+        CloseHandle (duplicate);
+    }
+    return false;
+}
+
+// RwSpinLockAsyncWait
+
+template <typename Lock, typename Guard, typename Callback>
+template <typename C>
+inline bool Windows::RwSpinLockAsyncWait <Lock, Guard, Callback>::Start (Lock & lock, Guard (*attempt) (Lock &, std::uint32_t) noexcept, C && callback, PTP_CALLBACK_ENVIRON environment) noexcept {
+    if (auto guard = attempt (lock, 0)) {
+        callback (std::move (guard));
+        return true;
+    }
+
+    if (auto wait = new (std::nothrow) RwSpinLockAsyncWait (&lock, attempt, std::forward <C> (callback))) {
+        if ((wait->timer = CreateThreadpoolTimer (&RwSpinLockAsyncWait::Retry, wait, environment)) != NULL) {
+
+            FILETIME due = {}; // absolute time in the past, run as soon as possible
+            SetThreadpoolTimer (wait->timer, &due, 0, 0);
+            return true;
+        }
+        delete wait;
+    }
+    return false;
+}
+
+// Retry
+//  - every previous attempt, including the one in Start, is reported as a round spent waiting
+//
+template <typename Lock, typename Guard, typename Callback>
+inline VOID CALLBACK Windows::RwSpinLockAsyncWait <Lock, Guard, Callback>::Retry (PTP_CALLBACK_INSTANCE, PVOID context, PTP_TIMER) noexcept {
+    auto wait = static_cast <RwSpinLockAsyncWait *> (context);
+
+    for (auto i = 0u; i != Parameters::Yields; ++i) {
+        if (auto guard = wait->attempt (*wait->lock, 1 + wait->round * Parameters::Yields + i)) {
+
+            // no other callback can be pending, timer is re-armed only below
+            CloseThreadpoolTimer (wait->timer);
+
+            wait->callback (std::move (guard));
+            delete wait;
+            return;
+        }
+        YieldProcessor ();
+    }
+
+    FILETIME due = {};
+    if (++wait->round > Parameters::Resubmits) {
+        ULARGE_INTEGER relative;
+        relative.QuadPart = static_cast <ULONGLONG> (-10'000LL); // 1 ms, in 100ns units, negative is relative
+
+        due.dwLowDateTime = relative.LowPart;
+        due.dwHighDateTime = relative.HighPart;
+    }
+    SetThreadpoolTimer (wait->timer, &due, 0, 0);
+}
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef WINDOWS_RWSPINLOCKETW_HPP
+#define WINDOWS_RWSPINLOCKETW_HPP
+
+#include "Windows_RwSpinLock.hpp"
+#include <TraceLoggingProvider.h>
+#include <winmeta.h>
+
+namespace Windows {
+
+    // RwSpinLockEtw
+    //  - Stats policy emitting ETW TraceLogging events from the slow paths, for live tracing in production
+    //    with WPR, tracelog, PerfView or any other ETW consumer, without rebuilding
+    //  - while no trace session has the provider enabled, each event costs only the provider level check
+    //  - fast path (uncontended acquisition, release) emits nothing
+    //  - Provider - TraceLogging provider handle, defined by the application in one translation unit,
+    //    and registered (TraceLoggingRegister) before use, e.g.:
+    //
+    //      TRACELOGGING_DEFINE_PROVIDER (RwSpinLockProvider, "RwSpinLock", (0x...));
+    //      using Lock = Windows::RwSpinLock <short, Windows::RwSpinLockEtw <RwSpinLockProvider>>;
+    //
+    //  - events, all with keyword 'Keyword' and "Lock" (address) and "Mode" (RwSpinLockMode) fields:
+    //     - Contended (info) - first failed attempt, the thread starts waiting
+    //     - Escalated (verbose) - waiting thread reached next back-off phase, "Phase" field is RwSpinLockPhase
+    //     - Acquired (info) - contended acquisition succeeded, "Rounds" field
+    //     - Timeout (warning) - timed acquisition failed, "Rounds" field
+    //     - UpgradeFailed (info) - TryUpgradeToExclusive failed
+    //
+    template <const TraceLoggingHProvider & Provider, ULONGLONG Keyword = 0x1>
+    struct RwSpinLockEtw {
+        static inline void Acquired (const void * lock, RwSpinLockMode mode, std::uint32_t rounds) noexcept {
+            if (rounds) {
+                TraceLoggingWrite (Provider, "Acquired",
+                                   TraceLoggingLevel (WINEVENT_LEVEL_INFO),
+                                   TraceLoggingKeyword (Keyword),
+                                   TraceLoggingPointer (lock, "Lock"),
+                                   TraceLoggingInt32 ((int) mode, "Mode"),
+                                   TraceLoggingUInt32 (rounds, "Rounds"));
+            }
+        }
+        static inline void Released (const void *, RwSpinLockMode) noexcept {}
+        static inline void Phase (const void * lock, RwSpinLockMode mode, RwSpinLockPhase phase) noexcept {
+            if (phase == RwSpinLockPhase::Pause) {
+                TraceLoggingWrite (Provider, "Contended",
+                                   TraceLoggingLevel (WINEVENT_LEVEL_INFO),
+                                   TraceLoggingKeyword (Keyword),
+                                   TraceLoggingPointer (lock, "Lock"),
+                                   TraceLoggingInt32 ((int) mode, "Mode"));
+            } else {
+                TraceLoggingWrite (Provider, "Escalated",
+                                   TraceLoggingLevel (WINEVENT_LEVEL_VERBOSE),
+                                   TraceLoggingKeyword (Keyword),
+                                   TraceLoggingPointer (lock, "Lock"),
+                                   TraceLoggingInt32 ((int) mode, "Mode"),
+                                   TraceLoggingInt32 ((int) phase, "Phase"));
+            }
+        }
+        static inline void Timeout (const void * lock, RwSpinLockMode mode, std::uint32_t rounds) noexcept {
+            TraceLoggingWrite (Provider, "Timeout",
+                               TraceLoggingLevel (WINEVENT_LEVEL_WARNING),
+                               TraceLoggingKeyword (Keyword),
+                               TraceLoggingPointer (lock, "Lock"),
+                               TraceLoggingInt32 ((int) mode, "Mode"),
+                               TraceLoggingUInt32 (rounds, "Rounds"));
+        }
+        static inline void UpgradeFailed (const void * lock) noexcept {
+            TraceLoggingWrite (Provider, "UpgradeFailed",
+                               TraceLoggingLevel (WINEVENT_LEVEL_INFO),
+                               TraceLoggingKeyword (Keyword),
+                               TraceLoggingPointer (lock, "Lock"),
+                               TraceLoggingInt32 ((int) RwSpinLockMode::Upgrade, "Mode"));
+        }
+        static inline void Site (const void *, RwSpinLockMode, const RwSpinLockSite &) noexcept {}
+        static inline DWORD Owner (const void *) noexcept { return 0; }
+    };
+}
+
+#endif
@@ -0,0 +1,130 @@
+#ifndef WINDOWS_RWSPINLOCKMONITOR_HPP
+#define WINDOWS_RWSPINLOCKMONITOR_HPP
+
+#include "Windows_RwSpinLockStatistics.hpp"
+#include <cstddef>
+
+namespace Windows {
+
+    // RwSpinLockMonitorSegment
+    //  - layout of the named shared memory segment published by RwSpinLockMonitor and read by LockTop
+    //  - Header is followed by 'capacity' Entries
+    //  - only fixed-size fields, so that 32-bit monitor can read 64-bit process and vice versa
+    //
+    struct RwSpinLockMonitorSegment {
+        static constexpr std::uint32_t Magic = 0x4C535752; // "RWSL"
+        static constexpr std::uint32_t Version = 2;
+        static constexpr std::uint32_t Buckets = 32;
+
+        struct Header {
+            std::uint32_t magic;
+            std::uint32_t version;
+            std::uint32_t capacity;
+            std::uint32_t process;
+            double frequency; // RwSpinLockTimestamp units per second
+            volatile long long dropped; // events of locks that didn't fit into 'capacity' entries
+        };
+
+        // Entry
+        //  - counters of a single lock, arrays are indexed by RwSpinLockMode
+        //  - 'buckets' is log2 histogram of contended wait times of all modes, last bucket collects all longer waits
+        //  - 'exclusive' and 'readers' are current holders in the publishing process only
+        //
+        struct alignas (64) Entry {
+            volatile long long lock; // address in the publishing process, 0 for unused entry
+            char name [48];
+            volatile long long acquired [3];
+            volatile long long contended [3];
+            volatile long long timeouts [3];
+            volatile long long waited [3]; // total contended wait time
+            volatile long long buckets [Buckets];
+            volatile long exclusive;
+            volatile long readers;
+        };
+
+        // Name
+        //  - writes default segment name for process 'id' into 'buffer'
+        //
+        static inline void Name (wchar_t (&buffer) [64], DWORD id) noexcept;
+
+        static inline std::size_t Size (std::uint32_t capacity) noexcept {
+            return sizeof (Header) + (64 - sizeof (Header) % 64) % 64 + capacity * sizeof (Entry);
+        }
+        static inline Entry * Entries (Header * header) noexcept {
+            return reinterpret_cast <Entry *> (reinterpret_cast <char *> (header) + Size (0));
+        }
+        static inline const Entry * Entries (const Header * header) noexcept {
+            return reinterpret_cast <const Entry *> (reinterpret_cast <const char *> (header) + Size (0));
+        }
+    };
+
+    // RwSpinLockMonitor
+    //  - Stats policy publishing per-lock counters into named shared memory segment (file mapping),
+    //    for external monitoring tools, see Test/LockTop.cpp
+    //  - the segment is created by Publish, at startup, named "Local\RwSpinLockMonitor.<process id>" by default;
+    //    locks are not monitored until then, the hooks never create it, as they run with the lock held
+    //  - counters are updated with interlocked instructions on every acquisition and release
+    //  - Capacity - maximum number of distinct locks in the segment, events of further locks are only counted
+    //    in the 'dropped' header field
+    //  - usage: Windows::RwSpinLock <short, Windows::RwSpinLockMonitor <>> lock;
+    //           Windows::RwSpinLockMonitor <>::Publish (); // at startup
+    //           Windows::RwSpinLockMonitor <>::Name (&lock, "cache index");
+    //
+    template <std::size_t Capacity = 256>
+    class RwSpinLockMonitor {
+    public:
+
+        // Publish
+        //  - creates the shared memory segment, 'name' null for default, returns false on failure
+        //  - segment of the same name created by other instantiation (e.g. in other module) is shared,
+        //    if it has the same Capacity, and rejected otherwise
+        //  - calls after success return true, failed call can be retried
+        //  - maps the memory and calibrates RwSpinLockTimestampFrequency, which takes about 10 ms
+        //
+        static inline bool Publish (const wchar_t * name = nullptr) noexcept;
+
+        // Name
+        //  - assigns display name to the lock, longer names are truncated to 47 characters
+        //  - publishes the segment if Publish wasn't called yet, thus shouldn't be called with a lock held
+        //  - returns false if the segment couldn't be created, or is full
+        //
+        static inline bool Name (const void * lock, const char * name) noexcept;
+
+    public:
+
+        // Stats policy, see RwSpinLockNoStatistics
+
+        static inline void Acquired (const void * lock, RwSpinLockMode mode, std::uint32_t rounds) noexcept;
+        static inline void Released (const void * lock, RwSpinLockMode mode) noexcept;
+        static inline void Phase (const void * lock, RwSpinLockMode, RwSpinLockPhase) noexcept {
+            Tracker::Phase (lock);
+        }
+        static inline void Timeout (const void * lock, RwSpinLockMode mode, std::uint32_t) noexcept {
+            std::uint64_t start;
+            std::uint64_t wait;
+
+            Tracker::Complete (lock, start, wait);
+            if (auto entry = Entry (lock)) {
+                InterlockedIncrement64 (&entry->timeouts [(int) mode]);
+            }
+        }
+        static inline void UpgradeFailed (const void *) noexcept {}
+        static inline void Site (const void *, RwSpinLockMode, const RwSpinLockSite &) noexcept {}
+        static inline DWORD Owner (const void *) noexcept { return 0; }
+
+    private:
+        using Tracker = RwSpinLockWaitTracker <RwSpinLockMonitor>;
+        using Registry = RwSpinLockRegistry <RwSpinLockMonitorSegment::Entry, Capacity>;
+
+        static inline RwSpinLockMonitorSegment::Entry * Entry (const void * lock) noexcept;
+
+        // segment
+        //  - state: 0 - not published (yet, or failed), 1 - being published, 2 - published
+        //
+        static inline RwSpinLockMonitorSegment::Header * volatile segment = nullptr;
+        static inline volatile long state = 0;
+    };
+}
+
+#include "Windows_RwSpinLockMonitor.tcc"
+#endif
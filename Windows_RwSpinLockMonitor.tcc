@@ -0,0 +1,167 @@
+#ifndef WINDOWS_RWSPINLOCKMONITOR_TCC
+#define WINDOWS_RWSPINLOCKMONITOR_TCC
+
+#include "Windows_RwSpinLockMonitor.hpp"
+#include <cwchar>
+
+// RwSpinLockMonitorSegment
+
+inline void Windows::RwSpinLockMonitorSegment::Name (wchar_t (&buffer) [64], DWORD id) noexcept {
+    std::swprintf (buffer, 64, L"Local\\RwSpinLockMonitor.%u", (unsigned int) id);
+}
+
+// RwSpinLockMonitor
+
+// Publish
+//  - existing segment of the same name is shared once its creator sets 'magic', the last written field
+//
+template <std::size_t Capacity>
+inline bool Windows::RwSpinLockMonitor <Capacity>::Publish (const wchar_t * name) noexcept {
+    switch (InterlockedCompareExchange (&state, 1, 0)) {
+        case 0:
+            break;
+        case 1:
+            while (state == 1) {
+                Sleep (0);
+            }
+            return state == 2;
+        default:
+            return true;
+    }
+
+    wchar_t buffer [64];
+    if (name == nullptr) {
+        RwSpinLockMonitorSegment::Name (buffer, GetCurrentProcessId ());
+        name = buffer;
+    }
+
+    const auto frequency = RwSpinLockTimestampFrequency ();
+    const auto size = RwSpinLockMonitorSegment::Size (Capacity);
+    if (auto mapping = CreateFileMappingW (INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                                           (DWORD) ((unsigned long long) size >> 32), (DWORD) size, name)) {
+        const auto existing = (GetLastError () == ERROR_ALREADY_EXISTS);
+
+        // smaller existing segment fails to map here
+        if (auto view = MapViewOfFile (mapping, FILE_MAP_WRITE, 0, 0, size)) {
+            auto header = static_cast <RwSpinLockMonitorSegment::Header *> (view);
+            if (!existing) {
+                header->version = RwSpinLockMonitorSegment::Version;
+                header->capacity = Capacity;
+                header->process = GetCurrentProcessId ();
+                header->frequency = frequency;
+                InterlockedExchange ((volatile long *) &header->magic, RwSpinLockMonitorSegment::Magic);
+            } else {
+                for (auto i = 0; i != 1000 && *(volatile std::uint32_t *) &header->magic == 0; ++i) {
+                    Sleep (1);
+                }
+            }
+
+            if (header->magic == RwSpinLockMonitorSegment::Magic
+                    && header->version == RwSpinLockMonitorSegment::Version
+                    && header->capacity == Capacity) {
+
+                // the mapping handle is intentionally leaked, the segment lives as long as the process
+                segment = header;
+                InterlockedExchange (&state, 2);
+                return true;
+            }
+            UnmapViewOfFile (view);
+        }
+        CloseHandle (mapping);
+    }
+    InterlockedExchange (&state, 0);
+    return false;
+}
+
+// Entry
+//  - RwSpinLockRegistry probing over the segment, entries are claimed by interlocked exchange of the 'lock' address
+//  - returns nullptr until the segment is published, and when it is full, counting the event as dropped
+//
+template <std::size_t Capacity>
+inline Windows::RwSpinLockMonitorSegment::Entry * Windows::RwSpinLockMonitor <Capacity>::Entry (const void * lock) noexcept {
+    auto header = segment;
+    if (header == nullptr)
+        return nullptr;
+
+    auto address = static_cast <long long> (reinterpret_cast <std::uintptr_t> (lock));
+    auto entry = Registry::Probe (RwSpinLockMonitorSegment::Entries (header), lock, 0,
+                                  [address] (RwSpinLockMonitorSegment::Entry & entry) noexcept {
+        auto current = entry.lock;
+        if (current == 0) {
+            current = InterlockedCompareExchange64 (&entry.lock, address, 0);
+            if (current == 0)
+                return Registry::Step::Found;
+        }
+        return (current == address) ? Registry::Step::Found : Registry::Step::Next;
+    });
+    if (entry == nullptr) {
+        InterlockedIncrement64 (&header->dropped);
+    }
+    return entry;
+}
+
+template <std::size_t Capacity>
+inline bool Windows::RwSpinLockMonitor <Capacity>::Name (const void * lock, const char * name) noexcept {
+    if (segment == nullptr && !Publish ())
+        return false;
+
+    if (auto entry = Entry (lock)) {
+        std::size_t i = 0;
+        for (; name [i] && i != sizeof entry->name - 1; ++i) {
+            entry->name [i] = name [i];
+        }
+        entry->name [i] = '\0';
+        return true;
+    } else
+        return false;
+}
+
+template <std::size_t Capacity>
+inline void Windows::RwSpinLockMonitor <Capacity>::Acquired (const void * lock, RwSpinLockMode mode, std::uint32_t rounds) noexcept {
+    std::uint64_t start;
+    std::uint64_t t;
+    const auto timed = Tracker::Complete (lock, start, t);
+
+    if (auto entry = Entry (lock)) {
+        InterlockedIncrement64 (&entry->acquired [(int) mode]);
+
+        if (rounds && timed) {
+            InterlockedIncrement64 (&entry->contended [(int) mode]);
+            InterlockedExchangeAdd64 (&entry->waited [(int) mode], (long long) t);
+
+            unsigned long index = 0;
+            while ((t >>= 1) && index != RwSpinLockMonitorSegment::Buckets - 1) {
+                ++index;
+            }
+            InterlockedIncrement64 (&entry->buckets [index]);
+        }
+
+        if (mode == RwSpinLockMode::Shared) {
+            InterlockedIncrement (&entry->readers);
+        } else {
+            InterlockedExchange (&entry->exclusive, 1);
+        }
+    }
+}
+
+// Released
+//  - ReleaseExclusive unlocks the lock completely, even if it was upgraded from shared
+//
+template <std::size_t Capacity>
+inline void Windows::RwSpinLockMonitor <Capacity>::Released (const void * lock, RwSpinLockMode mode) noexcept {
+    if (auto entry = Entry (lock)) {
+        switch (mode) {
+            case RwSpinLockMode::Exclusive:
+                InterlockedExchange (&entry->readers, 0);
+                [[fallthrough]];
+            case RwSpinLockMode::Upgrade:
+                InterlockedExchange (&entry->exclusive, 0);
+                break;
+            case RwSpinLockMode::Shared:
+                InterlockedDecrement (&entry->readers);
+                break;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,206 @@
+#ifndef WINDOWS_RWSPINLOCKPERCPU_HPP
+#define WINDOWS_RWSPINLOCKPERCPU_HPP
+
+#include "Windows_RwSpinLock.hpp"
+#include <cstddef>
+
+namespace Windows {
+    template <std::size_t Slots> class RwSpinLockPerCpuScopeShared;
+    template <std::size_t Slots> class RwSpinLockPerCpuScopeExclusive;
+
+    // RwSpinLockPerCpu
+    //  - reader-writer spin lock for read-mostly data, with reader count distributed into per-processor slots
+    //  - readers increment counter on cache line of the processor they currently run on, thus the interlocked
+    //    instruction is never contended and the cache line doesn't bounce between cores
+    //  - writers first take exclusive ownership of the 'writer' lock, which stops new readers, and then wait
+    //    until the sum of all slots drops to zero, i.e. writers have priority here and readers can be starved
+    //  - cross-process, contains no pointers, but size is (Slots + 1) cache lines
+    //  - Slots - number of reader counters, ideally the number of logical processors, rounded up
+    //    (processor index is group * 64 + number within the group, so that processors of different
+    //    processor groups don't share slots while Slots covers all groups)
+    //
+    template <std::size_t Slots = 64>
+    class RwSpinLockPerCpu {
+
+        // writer
+        //  - held exclusively by writer, shared only temporarily by readers waiting for writer to leave
+        //
+        alignas (64) RwSpinLock <long> writer;
+
+        // slots
+        //  - thread may release shared lock while running on different processor than where it has acquired it,
+        //    so individual slots can go negative, only the sum of all slots is number of readers
+        //
+        struct alignas (64) Slot {
+            volatile long readers;
+        } slots [Slots] = {};
+
+    public:
+
+        // C++ style "smart" if-scope operations
+
+        [[nodiscard]] inline RwSpinLockPerCpuScopeExclusive <Slots> exclusively (std::uint32_t * rounds = nullptr) noexcept;
+        [[nodiscard]] inline RwSpinLockPerCpuScopeExclusive <Slots> exclusively (std::uint64_t timeout, std::uint32_t * rounds = nullptr) noexcept;
+
+        [[nodiscard]] inline RwSpinLockPerCpuScopeShared <Slots> share (std::uint32_t * rounds = nullptr) noexcept;
+        [[nodiscard]] inline RwSpinLockPerCpuScopeShared <Slots> share (std::uint64_t timeout, std::uint32_t * rounds = nullptr) noexcept;
+
+    public:
+
+        // full API, same semantics as RwSpinLock
+
+        [[nodiscard]] inline bool TryAcquireExclusive () noexcept;
+        [[nodiscard]] inline bool TryAcquireShared () noexcept;
+
+        inline void AcquireExclusive (std::uint32_t * rounds = nullptr) noexcept;
+        inline void AcquireShared (std::uint32_t * rounds = nullptr) noexcept;
+
+        [[nodiscard]] inline bool AcquireExclusive (std::uint64_t timeout, std::uint32_t * rounds = nullptr) noexcept;
+        [[nodiscard]] inline bool AcquireShared (std::uint64_t timeout, std::uint32_t * rounds = nullptr) noexcept;
+
+        inline void ReleaseExclusive () noexcept {
+            this->writer.ReleaseExclusive ();
+        }
+        inline void ReleaseShared () noexcept {
+            InterlockedDecrement (&this->slot ().readers);
+        }
+
+        // TryUpgradeToExclusive
+        //  - succeeds only if there are no simultaneous readers and no writer is waiting
+        //
+        [[nodiscard]] inline bool TryUpgradeToExclusive () noexcept;
+
+        // DowngradeToShared
+        //  - converts exclusive lock to shared, then release using ReleaseShared
+        //
+        inline void DowngradeToShared () noexcept {
+            InterlockedIncrement (&this->slot ().readers);
+            this->writer.ReleaseExclusive ();
+        }
+
+        // ForceUnlock
+        //  - use only if the thread/process holding the lock crashed and there is no other reader active
+        //
+        inline void ForceUnlock () noexcept {
+            for (auto & slot : this->slots) {
+                InterlockedExchange (&slot.readers, 0);
+            }
+            this->writer.ForceUnlock ();
+        }
+
+        // IsLocked/IsLockedExclusively
+        //  - returns immediate state that may have already changed by the time the call returns
+        //  - IsLocked needs to sum all slots, it's much more expensive than on RwSpinLock
+        //
+        inline bool IsLocked () const noexcept {
+            return this->writer.IsLockedExclusively () || this->Readers () != 0;
+        }
+        inline bool IsLockedExclusively () const noexcept {
+            return this->writer.IsLockedExclusively () && this->Readers () == 0;
+        }
+
+    private:
+        inline Slot & slot () noexcept {
+            PROCESSOR_NUMBER processor;
+            GetCurrentProcessorNumberEx (&processor);
+            return this->slots [(processor.Group * 64u + processor.Number) % Slots];
+        }
+        inline long Readers () const noexcept {
+            long n = 0;
+            for (const auto & slot : this->slots) {
+                n += slot.readers;
+            }
+            return n;
+        }
+
+        inline bool Drain (const std::uint64_t * timeout, std::uint32_t * rounds) noexcept;
+        inline bool Enter (const std::uint64_t * timeout, std::uint32_t * rounds) noexcept;
+    };
+
+    // RwSpinLockPerCpuScopeExclusive
+    //  - unlocks exclusive lock acquired through RwSpinLockPerCpu::exclusively
+    //
+    template <std::size_t Slots>
+    class RwSpinLockPerCpuScopeExclusive {
+        friend class RwSpinLockPerCpu <Slots>;
+        RwSpinLockPerCpu <Slots> * lock;
+
+        inline RwSpinLockPerCpuScopeExclusive (RwSpinLockPerCpu <Slots> * lock) noexcept : lock (lock) {};
+
+    public:
+
+        // movable
+
+        inline RwSpinLockPerCpuScopeExclusive (RwSpinLockPerCpuScopeExclusive && from) noexcept : lock (from.lock) { from.lock = nullptr; }
+        inline RwSpinLockPerCpuScopeExclusive & operator = (RwSpinLockPerCpuScopeExclusive && from) noexcept { std::swap (this->lock, from.lock); return *this; }
+
+        // release lock on destruction
+
+        inline ~RwSpinLockPerCpuScopeExclusive () noexcept {
+            if (this->lock) {
+                this->release ();
+            }
+        }
+
+        // release
+        //  - to manually release the exclusive lock before going out of scope
+        //
+        inline void release () noexcept {
+            this->lock->ReleaseExclusive ();
+            this->lock = nullptr;
+        }
+
+        explicit operator bool () const & {
+            return this->lock != nullptr;
+        }
+
+#ifndef __INTELLISENSE__
+        explicit operator bool () const && = delete;
+#endif
+    };
+
+    // RwSpinLockPerCpuScopeShared
+    //  - unlocks shared lock acquired through RwSpinLockPerCpu::share
+    //
+    template <std::size_t Slots>
+    class RwSpinLockPerCpuScopeShared {
+        friend class RwSpinLockPerCpu <Slots>;
+        RwSpinLockPerCpu <Slots> * lock;
+
+        inline RwSpinLockPerCpuScopeShared (RwSpinLockPerCpu <Slots> * lock) noexcept : lock (lock) {};
+
+    public:
+
+        // movable
+
+        inline RwSpinLockPerCpuScopeShared (RwSpinLockPerCpuScopeShared && from) noexcept : lock (from.lock) { from.lock = nullptr; }
+        inline RwSpinLockPerCpuScopeShared & operator = (RwSpinLockPerCpuScopeShared && from) noexcept { std::swap (this->lock, from.lock); return *this; }
+
+        // release lock on destruction
+
+        inline ~RwSpinLockPerCpuScopeShared () noexcept {
+            if (this->lock) {
+                this->release ();
+            }
+        }
+
+        // release
+        //  - to manually release the shared lock before going out of scope
+        //
+        inline void release () noexcept {
+            this->lock->ReleaseShared ();
+            this->lock = nullptr;
+        }
+
+        explicit operator bool () const & {
+            return this->lock != nullptr;
+        }
+
+#ifndef __INTELLISENSE__
+        explicit operator bool () const && = delete;
+#endif
+    };
+}
+
+#include "Windows_RwSpinLockPerCpu.tcc"
+#endif
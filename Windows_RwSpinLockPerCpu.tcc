@@ -0,0 +1,182 @@
+#ifndef WINDOWS_RWSPINLOCKPERCPU_TCC
+#define WINDOWS_RWSPINLOCKPERCPU_TCC
+
+#include "Windows_RwSpinLockPerCpu.hpp"
+
+// RwSpinLockPerCpu
+
+template <std::size_t Slots>
+[[nodiscard]] inline bool Windows::RwSpinLockPerCpu <Slots>::TryAcquireExclusive () noexcept {
+    if (this->writer.TryAcquireExclusive ()) {
+        if (this->Readers () == 0)
+            return true;
+
+        this->writer.ReleaseExclusive ();
+    }
+    return false;
+}
+
+template <std::size_t Slots>
+[[nodiscard]] inline bool Windows::RwSpinLockPerCpu <Slots>::TryAcquireShared () noexcept {
+    if (!this->writer.IsLockedExclusively ()) {
+        auto & slot = this->slot ();
+
+        // interlocked increment is full barrier, the writer either sees our increment, or we see its ownership
+        InterlockedIncrement (&slot.readers);
+        if (!this->writer.IsLockedExclusively ())
+            return true;
+
+        // back off from the same slot, see Drain
+        InterlockedDecrement (&slot.readers);
+    }
+    return false;
+}
+
+template <std::size_t Slots>
+[[nodiscard]] inline bool Windows::RwSpinLockPerCpu <Slots>::TryUpgradeToExclusive () noexcept {
+    if (this->writer.TryAcquireExclusive ()) {
+        if (this->Readers () == 1) {
+            InterlockedDecrement (&this->slot ().readers);
+            return true;
+        }
+        this->writer.ReleaseExclusive ();
+    }
+    return false;
+}
+
+template <std::size_t Slots>
+inline void Windows::RwSpinLockPerCpu <Slots>::AcquireExclusive (std::uint32_t * rounds) noexcept {
+    this->writer.AcquireExclusive (rounds);
+    this->Drain (nullptr, rounds);
+}
+
+template <std::size_t Slots>
+[[nodiscard]] inline bool Windows::RwSpinLockPerCpu <Slots>::AcquireExclusive (std::uint64_t timeout, std::uint32_t * rounds) noexcept {
+    auto t0 = GetTickCount64 ();
+    if (this->writer.AcquireExclusive (timeout, rounds)) {
+
+        auto elapsed = GetTickCount64 () - t0;
+        std::uint64_t remaining = (elapsed < timeout) ? timeout - elapsed : 0;
+
+        if (this->Drain (&remaining, rounds))
+            return true;
+
+        this->writer.ReleaseExclusive ();
+    }
+    return false;
+}
+
+template <std::size_t Slots>
+inline void Windows::RwSpinLockPerCpu <Slots>::AcquireShared (std::uint32_t * rounds) noexcept {
+    this->Enter (nullptr, rounds);
+}
+
+template <std::size_t Slots>
+[[nodiscard]] inline bool Windows::RwSpinLockPerCpu <Slots>::AcquireShared (std::uint64_t timeout, std::uint32_t * rounds) noexcept {
+    return this->Enter (&timeout, rounds);
+}
+
+// internals
+
+// Enter
+//  - readers wait for the writer by briefly sharing the 'writer' lock, which uses all the spinning logic
+//    of RwSpinLock, and then retry, as another writer might have beaten them
+//
+template <std::size_t Slots>
+inline bool Windows::RwSpinLockPerCpu <Slots>::Enter (const std::uint64_t * timeout, std::uint32_t * rounds) noexcept {
+    std::uint32_t r = 0;
+    std::uint64_t t = 0;
+
+    while (!this->TryAcquireShared ()) {
+        std::uint32_t n = 0;
+        if (timeout) {
+            if (!t) {
+                t = GetTickCount64 () + *timeout;
+            }
+            auto now = GetTickCount64 ();
+            if (now >= t || !this->writer.AcquireShared (t - now, &n)) {
+                if (rounds) {
+                    *rounds = r + n;
+                }
+                return false;
+            }
+        } else {
+            this->writer.AcquireShared (&n);
+        }
+        this->writer.ReleaseShared ();
+        r += n + 1;
+    }
+    if (rounds) {
+        *rounds = r;
+    }
+    return true;
+}
+
+// Drain
+//  - waits, holding 'writer' lock, until all readers leave
+//  - slot is always incremented and decremented by the same reader entering and backing off,
+//    so summing the slots never misses a reader that holds the lock
+//  - follows the exclusive back-off schedule of RwSpinLock, for the current RwSpinLockEnvironment
+//  - rounds spent are added to 'rounds' also on timeout, as RwSpinLock reports them
+//
+template <std::size_t Slots>
+inline bool Windows::RwSpinLockPerCpu <Slots>::Drain (const std::uint64_t * timeout, std::uint32_t * rounds) noexcept {
+    using Writer = decltype (this->writer);
+    using Timings = typename Writer::Parameters::Exclusive;
+
+    std::uint32_t r = 0;
+    std::uint64_t t = 0;
+
+    while (this->Readers () != 0) {
+        if (++r <= Writer::template Yields <Timings> ()) {
+            YieldProcessor ();
+        } else {
+            if (timeout) {
+                if (!t) {
+                    t = GetTickCount64 () + *timeout;
+                } else
+                if (GetTickCount64 () >= t) {
+                    if (rounds) {
+                        *rounds += r;
+                    }
+                    return false;
+                }
+            }
+            Writer::Spin (Writer::template Escalate <Timings> (r));
+        }
+    }
+    if (rounds) {
+        *rounds += r;
+    }
+    return true;
+}
+
+// if scope
+
+template <std::size_t Slots>
+[[nodiscard]] inline Windows::RwSpinLockPerCpuScopeExclusive <Slots> Windows::RwSpinLockPerCpu <Slots>::exclusively (std::uint32_t * rounds) noexcept {
+    this->AcquireExclusive (rounds);
+    return this;
+}
+template <std::size_t Slots>
+[[nodiscard]] inline Windows::RwSpinLockPerCpuScopeExclusive <Slots> Windows::RwSpinLockPerCpu <Slots>::exclusively (std::uint64_t timeout, std::uint32_t * rounds) noexcept {
+    if (this->AcquireExclusive (timeout, rounds))
+        return this;
+    else
+        return nullptr;
+}
+
+template <std::size_t Slots>
+[[nodiscard]] inline Windows::RwSpinLockPerCpuScopeShared <Slots> Windows::RwSpinLockPerCpu <Slots>::share (std::uint32_t * rounds) noexcept {
+    this->AcquireShared (rounds);
+    return this;
+}
+template <std::size_t Slots>
+[[nodiscard]] inline Windows::RwSpinLockPerCpuScopeShared <Slots> Windows::RwSpinLockPerCpu <Slots>::share (std::uint64_t timeout, std::uint32_t * rounds) noexcept {
+    if (this->AcquireShared (timeout, rounds))
+        return this;
+    else
+        return nullptr;
+}
+
+#endif
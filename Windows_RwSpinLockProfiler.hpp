@@ -0,0 +1,98 @@
+#ifndef WINDOWS_RWSPINLOCKPROFILER_HPP
+#define WINDOWS_RWSPINLOCKPROFILER_HPP
+
+#include "Windows_RwSpinLockStatistics.hpp"
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+namespace Windows {
+
+    // RwSpinLockProfiler
+    //  - Stats policy attributing contention to call sites, i.e. to source locations of the scope functions
+    //    exclusively, share and upgrade, which capture them by default (see RwSpinLockSite)
+    //  - only every 'Rate'-th contended acquisition of each thread is sampled, wait time is measured
+    //    in RwSpinLockTimestamp units from the first failed attempt until the lock is acquired or timed out
+    //  - samples are aggregated per lock, mode and call site; acquisitions through the full API (Acquire*)
+    //    have no site and are aggregated under null 'file'
+    //  - Capacity - maximum number of distinct (lock, mode, site) combinations, further samples are dropped
+    //  - usage: Windows::RwSpinLock <short, Windows::RwSpinLockProfiler <>> lock;
+    //
+    template <std::size_t Capacity = 1024, std::uint32_t Rate = 16>
+    class RwSpinLockProfiler {
+    public:
+
+        // CallSite
+        //  - aggregated samples of single call site
+        //
+        struct alignas (64) CallSite {
+            volatile long state; // 0 - unused, 1 - being claimed, 2 - used
+            const void * lock;
+            const char * file;
+            const char * function;
+            std::uint32_t line;
+            RwSpinLockMode mode;
+
+            volatile long long samples;
+            volatile long long timeouts;
+            volatile long long total; // sum of sampled wait times
+            volatile long long max;
+        };
+
+        // Top
+        //  - calls 'f' with reference to the CallSite, for up to 'n' sites with the highest total wait time, in order
+        //
+        template <typename F>
+        static inline void Top (std::size_t n, F && f);
+
+        // Report
+        //  - writes human readable table of the top 'n' sites into 'output'
+        //
+        static inline void Report (std::FILE * output, std::size_t n = 20);
+
+        // Dropped
+        //  - number of samples dropped because the table was full
+        //
+        static inline long long Dropped () noexcept {
+            return RwSpinLockProfiler::dropped;
+        }
+
+        // Reset
+        //  - zeroes all samples, keeps the sites
+        //
+        static inline void Reset () noexcept;
+
+    public:
+
+        // Stats policy, see RwSpinLockNoStatistics
+
+        static inline void Acquired (const void * lock, RwSpinLockMode mode, std::uint32_t) noexcept {
+            RwSpinLockProfiler::Complete (lock, mode, false);
+        }
+        static inline void Released (const void *, RwSpinLockMode) noexcept {}
+        static inline void Phase (const void * lock, RwSpinLockMode mode, RwSpinLockPhase) noexcept;
+        static inline void Timeout (const void * lock, RwSpinLockMode mode, std::uint32_t) noexcept {
+            RwSpinLockProfiler::Complete (lock, mode, true);
+        }
+        static inline void UpgradeFailed (const void *) noexcept {
+            Tracker::Forget ();
+        }
+        static inline void Site (const void *, RwSpinLockMode, const RwSpinLockSite & site) noexcept {
+            Tracker::Site (site);
+        }
+        static inline DWORD Owner (const void *) noexcept { return 0; }
+
+    private:
+        using Tracker = RwSpinLockWaitTracker <RwSpinLockProfiler>;
+        using Registry = RwSpinLockRegistry <CallSite, Capacity>;
+
+        static inline void Complete (const void * lock, RwSpinLockMode mode, bool timeout) noexcept;
+        static inline CallSite * Entry (const void * lock, RwSpinLockMode mode, const RwSpinLockSite & site) noexcept;
+
+        static inline CallSite table [Capacity] = {};
+        static inline volatile long long dropped = 0;
+    };
+}
+
+#include "Windows_RwSpinLockProfiler.tcc"
+#endif
@@ -0,0 +1,132 @@
+#ifndef WINDOWS_RWSPINLOCKPROFILER_TCC
+#define WINDOWS_RWSPINLOCKPROFILER_TCC
+
+#include "Windows_RwSpinLockProfiler.hpp"
+
+// RwSpinLockProfiler
+
+// Phase
+//  - first call for the acquisition marks its start, every 'Rate'-th one is sampled
+//
+template <std::size_t Capacity, std::uint32_t Rate>
+inline void Windows::RwSpinLockProfiler <Capacity, Rate>::Phase (const void * lock, RwSpinLockMode, RwSpinLockPhase) noexcept {
+    Tracker::Phase (lock, [] () noexcept { return Rate; });
+}
+
+template <std::size_t Capacity, std::uint32_t Rate>
+inline void Windows::RwSpinLockProfiler <Capacity, Rate>::Complete (const void * lock, RwSpinLockMode mode, bool timeout) noexcept {
+    auto site = Tracker::Site ();
+    std::uint64_t start;
+    std::uint64_t wait;
+
+    if (Tracker::Complete (lock, start, wait)) {
+        auto cycles = static_cast <long long> (wait);
+
+        if (auto entry = Entry (lock, mode, site)) {
+            InterlockedIncrement64 (&entry->samples);
+            InterlockedExchangeAdd64 (&entry->total, cycles);
+            if (timeout) {
+                InterlockedIncrement64 (&entry->timeouts);
+            }
+
+            auto max = entry->max;
+            while (max < cycles) {
+                auto previous = InterlockedCompareExchange64 (&entry->max, cycles, max);
+                if (previous == max)
+                    break;
+
+                max = previous;
+            }
+        } else {
+            InterlockedIncrement64 (&dropped);
+        }
+    }
+}
+
+// Entry
+//  - RwSpinLockRegistry probing on (lock, line, mode), entries are never released
+//  - the same file name literal may have different address in different translation units, thus strcmp
+//  - entry being claimed by other thread is waited for, it's a matter of few instructions
+//
+template <std::size_t Capacity, std::uint32_t Rate>
+inline typename Windows::RwSpinLockProfiler <Capacity, Rate>::CallSite *
+Windows::RwSpinLockProfiler <Capacity, Rate>::Entry (const void * lock, RwSpinLockMode mode, const RwSpinLockSite & site) noexcept {
+    const auto salt = (site.line * 0x9E3779B1u) ^ (static_cast <std::size_t> (mode) << 7);
+
+    return Registry::Probe (table, lock, salt, [&] (CallSite & entry) noexcept {
+        if (entry.state == 0) {
+            if (InterlockedCompareExchange (&entry.state, 1, 0) == 0) {
+                entry.lock = lock;
+                entry.file = site.file;
+                entry.function = site.function;
+                entry.line = site.line;
+                entry.mode = mode;
+                InterlockedExchange (&entry.state, 2);
+                return Registry::Step::Found;
+            }
+        }
+        while (entry.state == 1) {
+            YieldProcessor ();
+        }
+
+        if (entry.lock == lock && entry.line == site.line && entry.mode == mode) {
+            if (entry.file == site.file)
+                return Registry::Step::Found;
+            if (entry.file && site.file && std::strcmp (entry.file, site.file) == 0)
+                return Registry::Step::Found;
+        }
+        return Registry::Step::Next;
+    });
+}
+
+template <std::size_t Capacity, std::uint32_t Rate>
+template <typename F>
+inline void Windows::RwSpinLockProfiler <Capacity, Rate>::Top (std::size_t n, F && f) {
+    std::vector <const CallSite *> sites;
+    for (const auto & entry : table) {
+        if (entry.state == 2 && entry.samples) {
+            sites.push_back (&entry);
+        }
+    }
+
+    n = std::min (n, sites.size ());
+    std::partial_sort (sites.begin (), sites.begin () + n, sites.end (),
+                       [] (const CallSite * a, const CallSite * b) { return a->total > b->total; });
+
+    for (std::size_t i = 0; i != n; ++i) {
+        f (*sites [i]);
+    }
+}
+
+template <std::size_t Capacity, std::uint32_t Rate>
+inline void Windows::RwSpinLockProfiler <Capacity, Rate>::Report (std::FILE * output, std::size_t n) {
+    static const char * const modes [] = { "exclusive", "shared", "upgrade" };
+
+    std::fprintf (output, "%-18s %-9s %10s %8s %16s %12s %12s  %s\n",
+                  "lock", "mode", "samples", "timeouts", "total wait", "average", "max", "site");
+
+    Top (n, [output] (const CallSite & site) {
+        std::fprintf (output, "%-18p %-9s %10lld %8lld %16lld %12lld %12lld  %s:%u %s\n",
+                      site.lock, modes [(int) site.mode], site.samples, site.timeouts,
+                      site.total, site.total / site.samples, site.max,
+                      site.file ? site.file : "(full API)", site.line, site.function ? site.function : "");
+    });
+
+    if (auto count = Dropped ()) {
+        std::fprintf (output, "%lld samples dropped, table full\n", count);
+    }
+    std::fprintf (output, "1 in %u contended acquisitions sampled\n", Rate);
+}
+
+template <std::size_t Capacity, std::uint32_t Rate>
+inline void Windows::RwSpinLockProfiler <Capacity, Rate>::Reset () noexcept {
+    for (auto & entry : table) {
+        InterlockedExchange64 (&entry.samples, 0);
+        InterlockedExchange64 (&entry.timeouts, 0);
+        InterlockedExchange64 (&entry.total, 0);
+        InterlockedExchange64 (&entry.max, 0);
+    }
+    InterlockedExchange64 (&dropped, 0);
+}
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef WINDOWS_RWSPINLOCKSAMPLER_HPP
+#define WINDOWS_RWSPINLOCKSAMPLER_HPP
+
+#include "Windows_RwSpinLockStatistics.hpp"
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+namespace Windows {
+
+    // RwSpinLockSampler
+    //  - Stats policy keeping random sample of contended waits, with their duration and call site,
+    //    cheap enough to be always on in production
+    //  - the sampling decision is made only on the slow path, at the first failed attempt: about one
+    //    in 'Rate' contended acquisitions of each thread is timed, randomized so that periodic workloads
+    //    don't alias with the sampling; uncontended acquisitions and releases cost a thread-local compare,
+    //    scope functions additionally store their RwSpinLockSite
+    //  - sampled waits are kept in per-thread reservoirs of 'Samples' entries (reservoir sampling,
+    //    RwSpinLockThreadBuffers), i.e. uniform sample of all sampled waits since the thread started or since Clear
+    //  - reservoirs are read by Enumerate/Report, or dumped by Listen on a signal from other process
+    //  - usage: Windows::RwSpinLock <short, Windows::RwSpinLockSampler <>> lock;
+    //           Windows::RwSpinLockSampler <>::Listen (); // SetEvent "Local\RwSpinLockSampler.<pid>" to dump
+    //
+    template <std::size_t Samples = 256, std::uint32_t Rate = 64>
+    class RwSpinLockSampler {
+    public:
+
+        // Sample
+        //  - single sampled contended acquisition, times in RwSpinLockTimestamp units
+        //  - 'site' has null 'file' for acquisitions through the full API (Acquire*)
+        //
+        struct Sample {
+            std::uint64_t timestamp; // first failed attempt
+            std::uint64_t wait;      // until acquired or timed out
+            const void * lock;
+            RwSpinLockSite site;
+            RwSpinLockMode mode;
+            bool timeout;
+        };
+
+        // Enumerate
+        //  - calls 'f' (thread id, pointer to samples, count, number of waits sampled) for every thread reservoir
+        //  - samples are copied first; reservoir being written during the copy is retried
+        //
+        template <typename F>
+        static inline void Enumerate (F && f);
+
+        // Report
+        //  - writes human readable list of the 'n' longest sampled waits, and per-thread totals, into 'output'
+        //
+        static inline void Report (std::FILE * output, std::size_t n = 50);
+
+        // Listen
+        //  - creates named auto-reset event and dumps Report into 'output' every time it's signalled,
+        //    from a thread pool thread; 'name' null for default "Local\RwSpinLockSampler.<process id>"
+        //  - returns false on failure or if already listening
+        //
+        static inline bool Listen (std::FILE * output = stderr, const wchar_t * name = nullptr) noexcept;
+
+        // Clear
+        //  - empties all reservoirs
+        //
+        static inline void Clear () noexcept;
+
+    public:
+
+        // Stats policy, see RwSpinLockNoStatistics
+
+        static inline void Acquired (const void * lock, RwSpinLockMode mode, std::uint32_t) noexcept {
+            RwSpinLockSampler::Complete (lock, mode, false);
+        }
+        static inline void Released (const void *, RwSpinLockMode) noexcept {}
+        static inline void Phase (const void * lock, RwSpinLockMode, RwSpinLockPhase) noexcept;
+        static inline void Timeout (const void * lock, RwSpinLockMode mode, std::uint32_t) noexcept {
+            RwSpinLockSampler::Complete (lock, mode, true);
+        }
+        static inline void UpgradeFailed (const void *) noexcept {
+            Tracker::Forget ();
+        }
+        static inline void Site (const void *, RwSpinLockMode, const RwSpinLockSite & site) noexcept {
+            Tracker::Site (site);
+        }
+        static inline DWORD Owner (const void *) noexcept { return 0; }
+
+    private:
+
+        // Reservoir
+        //  - samples of a single thread, written only by owner
+        //  - 'sequence' is odd while the owner updates the reservoir, readers retry
+        //  - 'seen' is number of waits offered to the reservoir, valid only while 'epoch' equals 'clears';
+        //    Clear just increments 'clears' and the owner starts over, so Clear never races the owner's stores
+        //
+        struct Reservoir {
+            volatile long sequence = 0;
+            volatile long clears = 0;
+            volatile long epoch = 0;
+            volatile long long seen = 0;
+            Sample samples [Samples];
+
+            inline void Reset () noexcept {
+                this->epoch = this->clears;
+                this->seen = 0;
+            }
+        };
+
+        using Reservoirs = RwSpinLockThreadBuffers <Reservoir>;
+        using Tracker = RwSpinLockWaitTracker <RwSpinLockSampler>;
+
+        static inline void Complete (const void * lock, RwSpinLockMode mode, bool timeout) noexcept;
+        static inline std::uint32_t Random () noexcept;
+        static inline VOID CALLBACK Signalled (PVOID, BOOLEAN) noexcept;
+
+        static inline std::FILE * output = nullptr;
+        static inline HANDLE volatile event = NULL;
+        static inline HANDLE registration = NULL;
+
+        // xorshift state of the thread, seeded on first use
+        static inline thread_local std::uint32_t random = 0;
+    };
+}
+
+#include "Windows_RwSpinLockSampler.tcc"
+#endif
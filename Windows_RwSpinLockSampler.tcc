@@ -0,0 +1,207 @@
+#ifndef WINDOWS_RWSPINLOCKSAMPLER_TCC
+#define WINDOWS_RWSPINLOCKSAMPLER_TCC
+
+#include "Windows_RwSpinLockSampler.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cwchar>
+
+// RwSpinLockSampler
+
+// Phase
+//  - first call for the acquisition marks its start and decides whether to sample it,
+//    countdown is drawn uniformly from 1 .. 2*Rate-1, averaging one sample in 'Rate' waits
+//
+template <std::size_t Samples, std::uint32_t Rate>
+inline void Windows::RwSpinLockSampler <Samples, Rate>::Phase (const void * lock, RwSpinLockMode, RwSpinLockPhase) noexcept {
+    Tracker::Phase (lock, [] () noexcept { return 1 + Random () % (2 * Rate - 1); });
+}
+
+// Complete
+//  - offers sampled wait to the thread's reservoir: first 'Samples' waits are stored,
+//    later ones replace random sample with probability Samples/seen
+//  - after Clear the reservoir starts over with the first wait
+//
+template <std::size_t Samples, std::uint32_t Rate>
+inline void Windows::RwSpinLockSampler <Samples, Rate>::Complete (const void * lock, RwSpinLockMode mode, bool timeout) noexcept {
+    auto site = Tracker::Site ();
+    std::uint64_t start;
+    std::uint64_t wait;
+
+    if (Tracker::Complete (lock, start, wait)) {
+        if (auto reservoir = Reservoirs::Current ()) {
+            long clears = reservoir->clears;
+            long long seen = (reservoir->epoch == clears) ? reservoir->seen + 1 : 1;
+            auto slot = seen - 1;
+            if (seen > (long long) Samples) {
+                slot = ((std::uint64_t (Random ()) << 32) | Random ()) % seen;
+            }
+
+            reservoir->sequence = reservoir->sequence + 1;
+            std::atomic_thread_fence (std::memory_order_release);
+
+            if (slot < (long long) Samples) {
+                auto & sample = reservoir->samples [slot];
+                sample.timestamp = start;
+                sample.wait = wait;
+                sample.lock = lock;
+                sample.site = site;
+                sample.mode = mode;
+                sample.timeout = timeout;
+            }
+            reservoir->epoch = clears;
+            reservoir->seen = seen;
+
+            std::atomic_thread_fence (std::memory_order_release);
+            reservoir->sequence = reservoir->sequence + 1;
+        }
+    }
+}
+
+// Random
+//  - thread-local xorshift32
+//
+template <std::size_t Samples, std::uint32_t Rate>
+inline std::uint32_t Windows::RwSpinLockSampler <Samples, Rate>::Random () noexcept {
+    auto x = random;
+    if (x == 0) {
+        x = static_cast <std::uint32_t> (RwSpinLockTimestamp ()) ^ (GetCurrentThreadId () * 2654435761u);
+        if (x == 0) {
+            x = 1;
+        }
+    }
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return random = x;
+}
+
+// Enumerate
+//  - reservoir cleared but not written since is empty
+//
+template <std::size_t Samples, std::uint32_t Rate>
+template <typename F>
+inline void Windows::RwSpinLockSampler <Samples, Rate>::Enumerate (F && f) {
+    std::vector <Sample> samples;
+    long long seen = 0;
+    samples.reserve (Samples);
+
+    Reservoirs::Enumerate ([&samples, &seen] (const Reservoir & reservoir) {
+        samples.clear ();
+        seen = 0;
+
+        for (auto attempt = 0; attempt != 16; ++attempt) {
+            long sequence = reservoir.sequence;
+            if (sequence & 1) {
+                SwitchToThread ();
+                continue;
+            }
+            std::atomic_thread_fence (std::memory_order_acquire);
+
+            seen = (reservoir.epoch == reservoir.clears) ? reservoir.seen : 0;
+            samples.assign (reservoir.samples, reservoir.samples + std::min ((long long) Samples, seen));
+
+            std::atomic_thread_fence (std::memory_order_acquire);
+            if (reservoir.sequence == sequence)
+                break;
+
+            samples.clear ();
+            seen = 0;
+        }
+    }, [&samples, &seen, &f] (DWORD thread) {
+        if (!samples.empty ()) {
+            f (thread, samples.data (), samples.size (), seen);
+        }
+    });
+}
+
+template <std::size_t Samples, std::uint32_t Rate>
+inline void Windows::RwSpinLockSampler <Samples, Rate>::Report (std::FILE * output, std::size_t n) {
+    static const char * const modes [] = { "exclusive", "shared", "upgrade" };
+
+    struct Row {
+        DWORD thread;
+        Sample sample;
+    };
+    std::vector <Row> rows;
+
+    const auto frequency = RwSpinLockTimestampFrequency () / 1000000.0; // units per microsecond
+
+    std::fprintf (output, "%8s %10s %10s %14s %14s\n", "thread", "sampled", "stored", "avg wait us", "max wait us");
+    Enumerate ([&] (DWORD thread, const Sample * samples, std::size_t count, long long seen) {
+        std::uint64_t total = 0;
+        std::uint64_t max = 0;
+        for (auto i = 0u; i != count; ++i) {
+            total += samples [i].wait;
+            max = std::max (max, samples [i].wait);
+            rows.push_back ({ thread, samples [i] });
+        }
+        std::fprintf (output, "%8u %10lld %10u %14.2f %14.2f\n",
+                      (unsigned) thread, seen, (unsigned) count, total / frequency / count, max / frequency);
+    });
+
+    n = std::min (n, rows.size ());
+    std::partial_sort (rows.begin (), rows.begin () + n, rows.end (),
+                       [] (const Row & a, const Row & b) { return a.sample.wait > b.sample.wait; });
+
+    std::fprintf (output, "\n%8s %18s %-10s %12s  %s\n", "thread", "lock", "mode", "wait us", "site");
+    for (auto i = 0u; i != n; ++i) {
+        const auto & row = rows [i];
+        std::fprintf (output, "%8u %18p %-10s %12.2f  ",
+                      (unsigned) row.thread, row.sample.lock, modes [(int) row.sample.mode], row.sample.wait / frequency);
+        if (row.sample.site.file) {
+            std::fprintf (output, "%s:%u %s", row.sample.site.file, row.sample.site.line, row.sample.site.function);
+        } else {
+            std::fprintf (output, "(Acquire*)");
+        }
+        std::fprintf (output, "%s\n", row.sample.timeout ? " TIMEOUT" : "");
+    }
+    std::fflush (output);
+}
+
+template <std::size_t Samples, std::uint32_t Rate>
+inline VOID CALLBACK Windows::RwSpinLockSampler <Samples, Rate>::Signalled (PVOID, BOOLEAN) noexcept {
+    try {
+        Report (output);
+    } catch (...) {
+        // out of memory, nothing to report
+    }
+}
+
+template <std::size_t Samples, std::uint32_t Rate>
+inline bool Windows::RwSpinLockSampler <Samples, Rate>::Listen (std::FILE * output, const wchar_t * name) noexcept {
+    if (RwSpinLockSampler::event)
+        return false;
+
+    wchar_t buffer [64];
+    if (!name) {
+        std::swprintf (buffer, 64, L"Local\\RwSpinLockSampler.%u", (unsigned) GetCurrentProcessId ());
+        name = buffer;
+    }
+
+    auto event = CreateEventW (NULL, FALSE, FALSE, name);
+    if (!event)
+        return false;
+
+    if (InterlockedCompareExchangePointer (&RwSpinLockSampler::event, event, NULL) != NULL) {
+        CloseHandle (event);
+        return false;
+    }
+
+    RwSpinLockSampler::output = output;
+    if (!RegisterWaitForSingleObject (&RwSpinLockSampler::registration, event, &RwSpinLockSampler::Signalled, nullptr, INFINITE, WT_EXECUTEDEFAULT)) {
+        RwSpinLockSampler::event = NULL;
+        CloseHandle (event);
+        return false;
+    }
+    return true;
+}
+
+template <std::size_t Samples, std::uint32_t Rate>
+inline void Windows::RwSpinLockSampler <Samples, Rate>::Clear () noexcept {
+    Reservoirs::ForEach ([] (Reservoir & reservoir) {
+        InterlockedIncrement (&reservoir.clears);
+    });
+}
+
+#endif
@@ -0,0 +1,339 @@
+#ifndef WINDOWS_RWSPINLOCKSTATISTICS_HPP
+#define WINDOWS_RWSPINLOCKSTATISTICS_HPP
+
+#include "Windows_RwSpinLock.hpp"
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Windows {
+
+    // RwSpinLockTimestamp
+    //  - timestamp for instrumentation policies, in TSC cycles on x86/x64, QueryPerformanceCounter units elsewhere
+    //  - RDTSCP waits for all previous instructions to execute, e.g. for the critical section to complete
+    //
+    inline std::uint64_t RwSpinLockTimestamp () noexcept;
+
+    // RwSpinLockTimestampFrequency
+    //  - RwSpinLockTimestamp units per second, TSC frequency is calibrated against QueryPerformanceCounter
+    //    on the first call, which takes about 10 ms
+    //
+    inline double RwSpinLockTimestampFrequency () noexcept;
+
+    // RwSpinLockRegistry
+    //  - process-wide table of per-lock records of instrumentation policies, indexed by hashed lock address,
+    //    so that the records never share cache line with the lock itself, and the lock doesn't grow in size
+    //  - Record - must be default-initializable, with 'const void * volatile lock' member (Probe has no such requirement)
+    //  - Capacity - maximum number of distinct locks tracked, further locks are all accounted into overflow record
+    //
+    template <typename Record, std::size_t Capacity>
+    class RwSpinLockRegistry {
+    public:
+
+        // Step
+        //  - result of Probe's 'f' for a single record
+        //
+        enum class Step {
+            Next,   // continue with the next record
+            Found,  // the record is the one, Probe returns it
+            Stop,   // the lock is not in the table, Probe returns nullptr
+        };
+
+        // Probe
+        //  - the open addressing with linear probing of Entry and Find, for tables kept elsewhere (e.g. in shared
+        //    memory) or with other keys: calls 'f (record)' for the Capacity records of 'table' in probe order
+        //    of 'lock' (hash mixed with 'salt'), until it returns other Step than Next
+        //  - returns the Found record, or nullptr
+        //
+        template <typename F>
+        static inline Record * Probe (Record * table, const void * lock, std::size_t salt, F && f);
+
+        // Entry
+        //  - returns record for the 'lock', claiming new one on first use
+        //
+        static inline Record * Entry (const void * lock) noexcept;
+
+        // Find
+        //  - returns record for the 'lock', or nullptr if the lock was never reported
+        //
+        static inline const Record * Find (const void * lock) noexcept;
+
+        // Enumerate
+        //  - calls 'f' with reference to record of every reported lock, and lastly for the overflow record, if used
+        //  - overflow record has null 'lock'
+        //
+        template <typename F>
+        static inline void Enumerate (F && f);
+
+        // ForEach
+        //  - calls 'f' with reference to every record, used or not, including the overflow one
+        //
+        template <typename F>
+        static inline void ForEach (F && f);
+
+    private:
+        static inline std::size_t Hash (const void * lock) noexcept;
+        static inline Record table [Capacity + 1] = {};
+        static inline volatile long overflowed = 0;
+    };
+
+    // RwSpinLockThreadBuffers
+    //  - process-wide list of per-thread buffers of instrumentation policies, each written only by its owner thread,
+    //    so that recording needs no interlocked instruction
+    //  - buffers of exited threads are kept until reused by new threads, thus the memory is bounded by maximum
+    //    number of simultaneously running threads that used a lock
+    //  - Buffer - default-initializable, with 'Reset ()' called when a new thread takes the buffer over
+    //
+    template <typename Buffer>
+    class RwSpinLockThreadBuffers {
+    public:
+
+        // Current
+        //  - returns buffer owned by the calling thread, reuses free one or allocates new one on first use
+        //  - returns nullptr if the allocation fails
+        //
+        static inline Buffer * Current () noexcept;
+
+        // Enumerate
+        //  - for every buffer calls 'copy (const Buffer &)', which copies what the caller needs while the owner
+        //    may be writing, and then 'use (thread id)', unless a new thread took the buffer over in the meantime
+        //
+        template <typename Copy, typename Use>
+        static inline void Enumerate (Copy && copy, Use && use);
+
+        // ForEach
+        //  - calls 'f' with reference to every buffer, e.g. to clear it
+        //
+        template <typename F>
+        static inline void ForEach (F && f);
+
+    private:
+
+        // Node
+        //  - 'owned' is 0 while the buffer is free for reuse, 'thread' is id of the last owner
+        //  - 'generation' is odd while new owner resets the buffer
+        //
+        struct Node {
+            Node * next = nullptr;
+            volatile long owned = 0;
+            volatile long generation = 0;
+            DWORD thread = 0;
+            Buffer buffer;
+        };
+
+        // Ownership
+        //  - thread-local ownership of the buffer, returned for reuse on thread exit
+        //
+        struct Ownership {
+            Node * node = nullptr;
+            inline ~Ownership () noexcept {
+                if (this->node) {
+                    InterlockedExchange (&this->node->owned, 0);
+                }
+            }
+        };
+
+        static inline Node * volatile nodes = nullptr;
+        static inline thread_local Ownership owner;
+    };
+
+    // RwSpinLockWaitTracker
+    //  - per-thread state of contended acquisition in progress, common to the instrumentation policies:
+    //    the first Phase call of an acquisition starts the wait, Acquired or Timeout completes it
+    //  - optionally only every n-th wait is timed, and the call site of the scope function is kept
+    //  - Tag - the policy, so that each one, e.g. in RwSpinLockStatisticsChain, has its own state
+    //
+    template <typename Tag>
+    class RwSpinLockWaitTracker {
+    public:
+
+        // Phase
+        //  - starts tracking the wait for 'lock' on the first call of the acquisition, later calls do nothing
+        //  - next - returns number of waits until the next timed one (1 - every wait), called for timed waits,
+        //    the first wait of the thread is always timed
+        //
+        template <typename Next>
+        static inline void Phase (const void * lock, Next && next) noexcept;
+
+        static inline void Phase (const void * lock) noexcept {
+            Phase (lock, [] () noexcept { return 1u; });
+        }
+
+        // Complete
+        //  - ends the wait for 'lock', returns true if it was timed, 'start' then receives RwSpinLockTimestamp
+        //    of the first failed attempt and 'wait' the time since; the site is forgotten too
+        //  - acquisitions without prior Phase call on this thread (uncontended, or retried by other thread,
+        //    see async_exclusively) are not timed
+        //
+        static inline bool Complete (const void * lock, std::uint64_t & start, std::uint64_t & wait) noexcept;
+
+        // Site
+        //  - keeps call site of the scope function in progress, until Complete or Forget
+        //
+        static inline void Site (const RwSpinLockSite & site) noexcept {
+            current = site;
+        }
+        static inline const RwSpinLockSite & Site () noexcept {
+            return current;
+        }
+        static inline void Forget () noexcept {
+            current = {};
+        }
+
+    private:
+        static inline thread_local const void * waiting = nullptr;  // lock of the contended acquisition in progress
+        static inline thread_local std::uint64_t since = 0;         // first failed attempt, 0 if the wait isn't timed
+        static inline thread_local std::uint32_t countdown = 0;     // waits until the next timed one
+        static inline thread_local RwSpinLockSite current = {};
+    };
+
+    // RwSpinLockStatistics
+    //  - Stats policy for RwSpinLock counting, per lock: acquisitions per mode, contended acquisitions,
+    //    timeouts, failed upgrades, and how many times each escalation phase was reached
+    //  - each thread counts into its own table of 'Slots' locks (RwSpinLockThreadBuffers), with plain increments,
+    //    and the tables are summed when read; further locks of the thread are counted with interlocked increments
+    //    into shared RwSpinLockRegistry entry, which also keeps counts of exited threads, never on the lock's cache line
+    //  - Capacity - maximum number of distinct locks tracked, further locks are all accounted into overflow entry
+    //  - usage: Windows::RwSpinLock <short, Windows::RwSpinLockStatistics <>> lock;
+    //
+    template <std::size_t Capacity = 4096, std::size_t Slots = 64>
+    class RwSpinLockStatistics {
+    public:
+
+        // Counters
+        //  - statistics of a single lock, arrays are indexed by RwSpinLockMode and RwSpinLockPhase
+        //  - 'lock' is null for unused entries, and for the overflow entry
+        //
+        struct alignas (64) Counters {
+            const void * volatile lock;
+            volatile long long acquired [3];
+            volatile long long contended [3];
+            volatile long long timeouts [3];
+            volatile long long failures; // failed TryUpgradeToExclusive calls
+            volatile long long phases [5];
+        };
+
+        // Find
+        //  - returns counters for the 'lock', summed over all threads, with null 'lock' if the lock was never reported
+        //
+        static inline Counters Find (const void * lock) noexcept;
+
+        // Enumerate
+        //  - calls 'f' with reference to Counters of every reported lock, and lastly for the overflow entry, if used
+        //  - the counters are summed first, while being updated concurrently
+        //
+        template <typename F>
+        static inline void Enumerate (F && f);
+
+        // Reset
+        //  - zeroes all counters, keeps the lock entries
+        //  - threads zero their tables on their next update, until then the tables are not summed
+        //
+        static inline void Reset () noexcept;
+
+    public:
+
+        // Stats policy, see RwSpinLockNoStatistics
+
+        static inline void Acquired (const void * lock, RwSpinLockMode mode, std::uint32_t rounds) noexcept {
+            bool local;
+            auto entry = Entry (lock, local);
+            Increment (entry->acquired [(int) mode], local);
+            if (rounds) {
+                Increment (entry->contended [(int) mode], local);
+            }
+        }
+        static inline void Released (const void *, RwSpinLockMode) noexcept {}
+        static inline void Phase (const void * lock, RwSpinLockMode, RwSpinLockPhase phase) noexcept {
+            bool local;
+            auto entry = Entry (lock, local);
+            Increment (entry->phases [(int) phase], local);
+        }
+        static inline void Timeout (const void * lock, RwSpinLockMode mode, std::uint32_t) noexcept {
+            bool local;
+            auto entry = Entry (lock, local);
+            Increment (entry->timeouts [(int) mode], local);
+        }
+        static inline void UpgradeFailed (const void * lock) noexcept {
+            bool local;
+            auto entry = Entry (lock, local);
+            Increment (entry->failures, local);
+        }
+        static inline void Site (const void *, RwSpinLockMode, const RwSpinLockSite &) noexcept {}
+        static inline DWORD Owner (const void *) noexcept { return 0; }
+
+    private:
+        using Registry = RwSpinLockRegistry <Counters, Capacity>;
+        using Table = RwSpinLockRegistry <Counters, Slots>; // only Probe of thread's 'slots'
+
+        // Local
+        //  - counters of a single thread, written only by owner
+        //  - 'epoch' equals 'clears' while the counters are valid; Reset just increments 'clears'
+        //    and the owner zeroes the counters, so Reset never races the owner's increments
+        //  - reused table of exited thread is first added into shared entries
+        //
+        struct Local {
+            volatile long clears = 0;
+            volatile long epoch = 0;
+            Counters slots [Slots] = {};
+
+            inline void Reset () noexcept;
+            inline void Clear () noexcept;
+        };
+
+        using Locals = RwSpinLockThreadBuffers <Local>;
+
+        // Entry
+        //  - returns the thread's counters for the 'lock' and sets 'local', or the shared entry
+        //
+        static inline Counters * Entry (const void * lock, bool & local) noexcept;
+
+        static inline void Increment (volatile long long & counter, bool local) noexcept {
+            if (local) {
+                counter = counter + 1;
+            } else {
+                InterlockedIncrement64 (&counter);
+            }
+        }
+
+        // Add
+        //  - adds counters of 'from' into 'to', with interlocked additions if 'shared'
+        //
+        static inline void Add (Counters & to, const volatile Counters & from, bool shared) noexcept;
+    };
+
+    // RwSpinLockStatisticsChain
+    //  - Stats policy forwarding every call to all 'Policies', in order
+    //  - usage: Windows::RwSpinLock <short, Windows::RwSpinLockStatisticsChain <Windows::RwSpinLockStatistics <>, Windows::RwSpinLockTiming <>>> lock;
+    //
+    template <typename... Policies>
+    struct RwSpinLockStatisticsChain {
+        static inline void Acquired (const void * lock, RwSpinLockMode mode, std::uint32_t rounds) noexcept {
+            (Policies::Acquired (lock, mode, rounds), ...);
+        }
+        static inline void Released (const void * lock, RwSpinLockMode mode) noexcept {
+            (Policies::Released (lock, mode), ...);
+        }
+        static inline void Phase (const void * lock, RwSpinLockMode mode, RwSpinLockPhase phase) noexcept {
+            (Policies::Phase (lock, mode, phase), ...);
+        }
+        static inline void Timeout (const void * lock, RwSpinLockMode mode, std::uint32_t rounds) noexcept {
+            (Policies::Timeout (lock, mode, rounds), ...);
+        }
+        static inline void UpgradeFailed (const void * lock) noexcept {
+            (Policies::UpgradeFailed (lock), ...);
+        }
+        static inline void Site (const void * lock, RwSpinLockMode mode, const RwSpinLockSite & site) noexcept {
+            (Policies::Site (lock, mode, site), ...);
+        }
+        static inline DWORD Owner (const void * lock) noexcept {
+            DWORD owner = 0;
+            ((owner = owner ? owner : Policies::Owner (lock)), ...);
+            return owner;
+        }
+    };
+}
+
+#include "Windows_RwSpinLockStatistics.tcc"
+#endif
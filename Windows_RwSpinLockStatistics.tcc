@@ -0,0 +1,405 @@
+#ifndef WINDOWS_RWSPINLOCKSTATISTICS_TCC
+#define WINDOWS_RWSPINLOCKSTATISTICS_TCC
+
+#include "Windows_RwSpinLockStatistics.hpp"
+#include <atomic>
+#include <new>
+
+inline std::uint64_t Windows::RwSpinLockTimestamp () noexcept {
+#if defined (_M_IX86) || defined (_M_AMD64)
+    unsigned int aux;
+    return __rdtscp (&aux);
+#else
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter (&counter);
+    return counter.QuadPart;
+#endif
+}
+
+inline double Windows::RwSpinLockTimestampFrequency () noexcept {
+    static const double frequency = [] {
+        LARGE_INTEGER f;
+        QueryPerformanceFrequency (&f);
+#if defined (_M_IX86) || defined (_M_AMD64)
+        LARGE_INTEGER a, b;
+        QueryPerformanceCounter (&a);
+        auto t0 = RwSpinLockTimestamp ();
+        do {
+            QueryPerformanceCounter (&b);
+        } while (b.QuadPart - a.QuadPart < f.QuadPart / 100);
+        auto t1 = RwSpinLockTimestamp ();
+
+        return double (t1 - t0) * double (f.QuadPart) / double (b.QuadPart - a.QuadPart);
+#else
+        return double (f.QuadPart);
+#endif
+    } ();
+    return frequency;
+}
+
+// RwSpinLockRegistry
+
+// Hash
+//  - spreads lock addresses, which are often aligned and close to each other
+//
+template <typename Record, std::size_t Capacity>
+inline std::size_t Windows::RwSpinLockRegistry <Record, Capacity>::Hash (const void * lock) noexcept {
+    auto h = reinterpret_cast <std::uintptr_t> (lock);
+    h ^= h >> 17;
+    h *= 0x9E3779B1u;
+    h ^= h >> 13;
+    return h;
+}
+
+template <typename Record, std::size_t Capacity>
+template <typename F>
+inline Record * Windows::RwSpinLockRegistry <Record, Capacity>::Probe (Record * table, const void * lock, std::size_t salt, F && f) {
+    const auto h = Hash (lock) ^ salt;
+    for (std::size_t i = 0; i != Capacity; ++i) {
+        auto & entry = table [(h + i) % Capacity];
+        switch (f (entry)) {
+            case Step::Next:
+                break;
+            case Step::Found:
+                return &entry;
+            case Step::Stop:
+                return nullptr;
+        }
+    }
+    return nullptr;
+}
+
+// Entry
+//  - records are claimed by interlocked exchange of the 'lock' pointer and never released,
+//    so the lookup needs no locking
+//  - last record of the table is overflow for when the table gets full
+//
+template <typename Record, std::size_t Capacity>
+inline Record * Windows::RwSpinLockRegistry <Record, Capacity>::Entry (const void * lock) noexcept {
+    auto entry = Probe (table, lock, 0, [lock] (Record & entry) noexcept {
+        auto current = entry.lock;
+        if (current == nullptr) {
+            current = InterlockedCompareExchangePointer ((PVOID volatile *) &entry.lock, (PVOID) lock, nullptr);
+            if (current == nullptr)
+                return Step::Found;
+        }
+        return (current == lock) ? Step::Found : Step::Next;
+    });
+    if (entry)
+        return entry;
+
+    if (!overflowed) {
+        InterlockedExchange (&overflowed, 1);
+    }
+    return &table [Capacity];
+}
+
+template <typename Record, std::size_t Capacity>
+inline const Record * Windows::RwSpinLockRegistry <Record, Capacity>::Find (const void * lock) noexcept {
+    return Probe (table, lock, 0, [lock] (const Record & entry) noexcept {
+        if (entry.lock == lock)
+            return Step::Found;
+        else
+            return (entry.lock == nullptr) ? Step::Stop : Step::Next;
+    });
+}
+
+template <typename Record, std::size_t Capacity>
+template <typename F>
+inline void Windows::RwSpinLockRegistry <Record, Capacity>::Enumerate (F && f) {
+    for (std::size_t i = 0; i != Capacity; ++i) {
+        if (table [i].lock) {
+            f (const_cast <const Record &> (table [i]));
+        }
+    }
+    if (overflowed) {
+        f (const_cast <const Record &> (table [Capacity]));
+    }
+}
+
+template <typename Record, std::size_t Capacity>
+template <typename F>
+inline void Windows::RwSpinLockRegistry <Record, Capacity>::ForEach (F && f) {
+    for (auto & entry : table) {
+        f (entry);
+    }
+}
+
+// RwSpinLockThreadBuffers
+
+// Current
+//  - reused buffer is reset between two increments of 'generation', see Enumerate
+//
+template <typename Buffer>
+inline Buffer * Windows::RwSpinLockThreadBuffers <Buffer>::Current () noexcept {
+    if (auto node = owner.node)
+        return &node->buffer;
+
+    for (auto node = nodes; node; node = node->next) {
+        if (node->owned == 0 && InterlockedCompareExchange (&node->owned, 1, 0) == 0) {
+            InterlockedIncrement (&node->generation);
+            node->thread = GetCurrentThreadId ();
+            node->buffer.Reset ();
+            InterlockedIncrement (&node->generation);
+            return &(owner.node = node)->buffer;
+        }
+    }
+
+    if (auto node = new (std::nothrow) Node) {
+        node->owned = 1;
+        node->thread = GetCurrentThreadId ();
+
+        Node * next;
+        do {
+            node->next = next = nodes;
+        } while (InterlockedCompareExchangePointer ((PVOID volatile *) &nodes, node, next) != next);
+
+        return &(owner.node = node)->buffer;
+    }
+    return nullptr;
+}
+
+// Enumerate
+//  - the copy is discarded if 'generation' was odd, or changed, i.e. the buffer was reset for a new thread
+//
+template <typename Buffer>
+template <typename Copy, typename Use>
+inline void Windows::RwSpinLockThreadBuffers <Buffer>::Enumerate (Copy && copy, Use && use) {
+    for (auto node = nodes; node; node = node->next) {
+        long generation = node->generation;
+        std::atomic_thread_fence (std::memory_order_acquire);
+        if (generation & 1)
+            continue;
+
+        DWORD thread = node->thread;
+        copy (const_cast <const Buffer &> (node->buffer));
+
+        std::atomic_thread_fence (std::memory_order_acquire);
+        if (node->generation == generation) {
+            use (thread);
+        }
+    }
+}
+
+template <typename Buffer>
+template <typename F>
+inline void Windows::RwSpinLockThreadBuffers <Buffer>::ForEach (F && f) {
+    for (auto node = nodes; node; node = node->next) {
+        f (node->buffer);
+    }
+}
+
+// RwSpinLockWaitTracker
+
+template <typename Tag>
+template <typename Next>
+inline void Windows::RwSpinLockWaitTracker <Tag>::Phase (const void * lock, Next && next) noexcept {
+    if (waiting != lock) {
+        waiting = lock;
+        if (countdown <= 1) {
+            countdown = next ();
+            since = RwSpinLockTimestamp ();
+        } else {
+            --countdown;
+            since = 0;
+        }
+    }
+}
+
+template <typename Tag>
+inline bool Windows::RwSpinLockWaitTracker <Tag>::Complete (const void * lock, std::uint64_t & start, std::uint64_t & wait) noexcept {
+    const auto timed = since && waiting == lock;
+    if (timed) {
+        start = since;
+        wait = RwSpinLockTimestamp () - since;
+    }
+    waiting = nullptr;
+    since = 0;
+    current = {};
+    return timed;
+}
+
+// RwSpinLockStatistics
+
+// Entry
+//  - the lock is registered in the shared table when it gets a thread slot, so that Enumerate finds it
+//
+template <std::size_t Capacity, std::size_t Slots>
+inline typename Windows::RwSpinLockStatistics <Capacity, Slots>::Counters *
+Windows::RwSpinLockStatistics <Capacity, Slots>::Entry (const void * lock, bool & local) noexcept {
+    if (auto buffer = Locals::Current ()) {
+        if (buffer->epoch != buffer->clears) {
+            buffer->Clear ();
+        }
+
+        auto slot = Table::Probe (buffer->slots, lock, 0, [lock] (Counters & slot) noexcept {
+            if (slot.lock == nullptr) {
+                Registry::Entry (lock);
+                std::atomic_thread_fence (std::memory_order_release);
+                slot.lock = lock;
+                return Table::Step::Found;
+            }
+            return (slot.lock == lock) ? Table::Step::Found : Table::Step::Next;
+        });
+        if (slot) {
+            local = true;
+            return slot;
+        }
+    }
+    local = false;
+    return Registry::Entry (lock);
+}
+
+template <std::size_t Capacity, std::size_t Slots>
+inline void Windows::RwSpinLockStatistics <Capacity, Slots>::Add (Counters & to, const volatile Counters & from, bool shared) noexcept {
+    auto add = [shared] (volatile long long & n, long long value) noexcept {
+        if (shared) {
+            if (value) {
+                InterlockedExchangeAdd64 (&n, value);
+            }
+        } else {
+            n = n + value;
+        }
+    };
+    for (auto i = 0u; i != 3u; ++i) {
+        add (to.acquired [i], from.acquired [i]);
+        add (to.contended [i], from.contended [i]);
+        add (to.timeouts [i], from.timeouts [i]);
+    }
+    for (auto i = 0u; i != 5u; ++i) {
+        add (to.phases [i], from.phases [i]);
+    }
+    add (to.failures, from.failures);
+}
+
+// Local::Reset
+//  - called by RwSpinLockThreadBuffers when new thread takes over the table of an exited one,
+//    readers skip the table meanwhile
+//
+template <std::size_t Capacity, std::size_t Slots>
+inline void Windows::RwSpinLockStatistics <Capacity, Slots>::Local::Reset () noexcept {
+    if (this->epoch == this->clears) {
+        for (const auto & slot : this->slots) {
+            if (slot.lock) {
+                Add (*Registry::Entry (slot.lock), slot, true);
+            }
+        }
+    }
+    for (auto & slot : this->slots) {
+        slot = {};
+    }
+    this->epoch = this->clears;
+}
+
+// Local::Clear
+//  - zeroes the counters after Reset, keeping the slots, readers skip the table until 'epoch' is updated
+//
+template <std::size_t Capacity, std::size_t Slots>
+inline void Windows::RwSpinLockStatistics <Capacity, Slots>::Local::Clear () noexcept {
+    long clears = this->clears;
+    for (auto & slot : this->slots) {
+        const void * lock = slot.lock;
+        slot = {};
+        slot.lock = lock;
+    }
+    std::atomic_thread_fence (std::memory_order_release);
+    this->epoch = clears;
+}
+
+template <std::size_t Capacity, std::size_t Slots>
+inline typename Windows::RwSpinLockStatistics <Capacity, Slots>::Counters
+Windows::RwSpinLockStatistics <Capacity, Slots>::Find (const void * lock) noexcept {
+    Counters total = {};
+    if (auto entry = Registry::Find (lock)) {
+        total.lock = lock;
+        Add (total, *entry, false);
+    }
+
+    Counters copy;
+    bool found;
+
+    Locals::Enumerate ([lock, &copy, &found] (const Local & local) {
+        found = false;
+        if (local.epoch == local.clears) {
+            auto slot = Table::Probe (const_cast <Counters *> (local.slots), lock, 0, [lock] (const Counters & slot) noexcept {
+                if (slot.lock == lock)
+                    return Table::Step::Found;
+                else
+                    return (slot.lock == nullptr) ? Table::Step::Stop : Table::Step::Next;
+            });
+            if (slot) {
+                copy = {};
+                Add (copy, *slot, false);
+                found = true;
+            }
+        }
+    }, [&] (DWORD) {
+        if (found) {
+            total.lock = lock;
+            Add (total, copy, false);
+        }
+    });
+    return total;
+}
+
+// Enumerate
+//  - thread counters of locks missing in the registry, i.e. since it's full, are added to the overflow entry
+//
+template <std::size_t Capacity, std::size_t Slots>
+template <typename F>
+inline void Windows::RwSpinLockStatistics <Capacity, Slots>::Enumerate (F && f) {
+    std::vector <Counters> totals;
+    std::unordered_map <const void *, std::size_t> index;
+
+    Registry::Enumerate ([&totals, &index] (const Counters & entry) {
+        const void * lock = entry.lock;
+        index [lock] = totals.size ();
+        totals.emplace_back ();
+        totals.back ().lock = lock;
+        Add (totals.back (), entry, false);
+    });
+
+    std::vector <Counters> copy;
+    Locals::Enumerate ([&copy] (const Local & local) {
+        copy.clear ();
+        if (local.epoch == local.clears) {
+            for (const auto & slot : local.slots) {
+                if (slot.lock) {
+                    copy.emplace_back ();
+                    copy.back ().lock = slot.lock;
+                    Add (copy.back (), slot, false);
+                }
+            }
+        }
+    }, [&] (DWORD) {
+        for (const auto & counters : copy) {
+            auto i = index.find ((const void *) counters.lock);
+            if (i == index.end ()) {
+                i = index.find (nullptr);
+            }
+            if (i != index.end ()) {
+                Add (totals [i->second], counters, false);
+            }
+        }
+    });
+
+    for (const auto & counters : totals) {
+        f (counters);
+    }
+}
+
+template <std::size_t Capacity, std::size_t Slots>
+inline void Windows::RwSpinLockStatistics <Capacity, Slots>::Reset () noexcept {
+    Registry::ForEach ([] (Counters & entry) {
+        for (auto & n : entry.acquired) { InterlockedExchange64 (&n, 0); }
+        for (auto & n : entry.contended) { InterlockedExchange64 (&n, 0); }
+        for (auto & n : entry.timeouts) { InterlockedExchange64 (&n, 0); }
+        for (auto & n : entry.phases) { InterlockedExchange64 (&n, 0); }
+        InterlockedExchange64 (&entry.failures, 0);
+    });
+    Locals::ForEach ([] (Local & local) {
+        InterlockedIncrement (&local.clears);
+    });
+}
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef WINDOWS_RWSPINLOCKTIMING_HPP
+#define WINDOWS_RWSPINLOCKTIMING_HPP
+
+#include "Windows_RwSpinLockStatistics.hpp"
+#include <cstddef>
+#include <utility>
+
+namespace Windows {
+
+    // RwSpinLockTiming
+    //  - Stats policy for RwSpinLock measuring, per lock and mode, how long is the lock held and how long
+    //    do the threads wait for it, into log2-scale histograms of TSC cycles
+    //  - hold time is measured from acquisition (or successful upgrade) to ReleaseExclusive, ReleaseShared
+    //    or DowngradeToShared in the same thread; locks released by a different thread are not measured
+    //  - wait time is measured from the first failed attempt, uncontended acquisitions count as 0 cycles
+    //  - each thread tracks up to 'Depth' nested holds, deeper holds are not measured
+    //  - TSC frequency is constant on all reasonably recent processors, but not necessarily the nominal one
+    //  - Capacity - maximum number of distinct locks tracked, see RwSpinLockRegistry
+    //  - usage: Windows::RwSpinLock <short, Windows::RwSpinLockTiming <>> lock;
+    //
+    template <std::size_t Capacity = 256, std::size_t Depth = 16>
+    class RwSpinLockTiming {
+    public:
+
+        // Histogram
+        //  - buckets [i] counts durations in range [2^i, 2^(i+1)) cycles, bucket 0 also includes 0
+        //
+        struct Histogram {
+            volatile long long buckets [64];
+            volatile long long max;
+        };
+
+        // Timings
+        //  - histograms of a single lock, indexed by RwSpinLockMode
+        //
+        struct alignas (64) Timings {
+            const void * volatile lock;
+            Histogram hold [3];
+            Histogram wait [3];
+        };
+
+        // Summary
+        //  - percentiles are upper bounds of the bucket where the percentile falls, 'max' is exact
+        //
+        struct Summary {
+            std::uint64_t count;
+            std::uint64_t p50;
+            std::uint64_t p99;
+            std::uint64_t max;
+        };
+
+        // Hold/Wait
+        //  - summarizes hold or wait times of the 'lock' in 'mode', all zeros if the lock was never reported
+        //
+        static inline Summary Hold (const void * lock, RwSpinLockMode mode) noexcept;
+        static inline Summary Wait (const void * lock, RwSpinLockMode mode) noexcept;
+
+        // Summarize
+        //  - computes count, p50, p99 and max of a histogram
+        //
+        static inline Summary Summarize (const Histogram & histogram) noexcept;
+
+        // Find/Enumerate
+        //  - access to raw histograms, see RwSpinLockRegistry
+        //
+        static inline const Timings * Find (const void * lock) noexcept {
+            return Registry::Find (lock);
+        }
+        template <typename F>
+        static inline void Enumerate (F && f) {
+            Registry::Enumerate (std::forward <F> (f));
+        }
+
+        // Reset
+        //  - zeroes all histograms, keeps the lock entries, holds in progress are still measured
+        //
+        static inline void Reset () noexcept;
+
+    public:
+
+        // Stats policy, see RwSpinLockNoStatistics
+
+        static inline void Acquired (const void * lock, RwSpinLockMode mode, std::uint32_t rounds) noexcept;
+        static inline void Released (const void * lock, RwSpinLockMode mode) noexcept;
+        static inline void Phase (const void * lock, RwSpinLockMode, RwSpinLockPhase) noexcept {
+            Tracker::Phase (lock);
+        }
+        static inline void Timeout (const void * lock, RwSpinLockMode, std::uint32_t) noexcept {
+            std::uint64_t start;
+            std::uint64_t wait;
+            Tracker::Complete (lock, start, wait);
+        }
+        static inline void UpgradeFailed (const void *) noexcept {}
+        static inline void Site (const void *, RwSpinLockMode, const RwSpinLockSite &) noexcept {}
+        static inline DWORD Owner (const void *) noexcept { return 0; }
+
+    private:
+        using Registry = RwSpinLockRegistry <Timings, Capacity>;
+        using Tracker = RwSpinLockWaitTracker <RwSpinLockTiming>;
+
+        // Held
+        //  - lock held by the current thread, and since when
+        //
+        struct Held {
+            const void * lock;
+            RwSpinLockMode mode;
+            std::uint64_t tsc;
+        };
+
+        static inline thread_local Held held [Depth] = {};
+        static inline thread_local std::size_t depth = 0;
+
+        static inline void Record (Histogram & histogram, std::uint64_t cycles) noexcept;
+    };
+}
+
+#include "Windows_RwSpinLockTiming.tcc"
+#endif
@@ -0,0 +1,141 @@
+#ifndef WINDOWS_RWSPINLOCKTIMING_TCC
+#define WINDOWS_RWSPINLOCKTIMING_TCC
+
+#include "Windows_RwSpinLockTiming.hpp"
+
+// RwSpinLockTiming
+
+template <std::size_t Capacity, std::size_t Depth>
+inline void Windows::RwSpinLockTiming <Capacity, Depth>::Acquired (const void * lock, RwSpinLockMode mode, std::uint32_t rounds) noexcept {
+    std::uint64_t start;
+    std::uint64_t wait;
+    const auto timed = Tracker::Complete (lock, start, wait);
+
+    auto now = RwSpinLockTimestamp ();
+    auto entry = Registry::Entry (lock);
+
+    Record (entry->wait [(int) mode], (rounds && timed) ? wait : 0);
+
+    if (depth < Depth) {
+        held [depth++] = { lock, mode, now };
+    }
+}
+
+// Released
+//  - finds the most recent hold of the 'lock' by this thread
+//  - ReleaseExclusive of upgraded lock also releases the shared lock it was upgraded from
+//
+template <std::size_t Capacity, std::size_t Depth>
+inline void Windows::RwSpinLockTiming <Capacity, Depth>::Released (const void * lock, RwSpinLockMode mode) noexcept {
+    auto now = RwSpinLockTimestamp ();
+    auto i = depth;
+    while (i--) {
+        if (held [i].lock == lock) {
+            auto h = held [i];
+            std::copy (&held [i + 1], &held [depth], &held [i]);
+            --depth;
+
+            Record (Registry::Entry (lock)->hold [(int) h.mode], now - h.tsc);
+
+            if (h.mode == RwSpinLockMode::Upgrade && mode == RwSpinLockMode::Exclusive) {
+                mode = RwSpinLockMode::Shared;
+                continue;
+            }
+            break;
+        }
+    }
+}
+
+// Record
+//  - bit scan leaves 'index' undefined for zero mask, so zero (uncontended wait) goes to bucket 0 explicitly
+//
+template <std::size_t Capacity, std::size_t Depth>
+inline void Windows::RwSpinLockTiming <Capacity, Depth>::Record (Histogram & histogram, std::uint64_t cycles) noexcept {
+    unsigned long index = 0;
+    if (cycles) {
+#if defined (_M_AMD64) || defined (_M_ARM64)
+        if (!_BitScanReverse64 (&index, cycles)) {
+            index = 0;
+        }
+#else
+        if (_BitScanReverse (&index, static_cast <unsigned long> (cycles >> 32))) {
+            index += 32;
+        } else
+        if (!_BitScanReverse (&index, static_cast <unsigned long> (cycles))) {
+            index = 0;
+        }
+#endif
+    }
+    InterlockedIncrement64 (&histogram.buckets [index]);
+
+    auto max = histogram.max;
+    while (static_cast <std::uint64_t> (max) < cycles) {
+        auto previous = InterlockedCompareExchange64 (&histogram.max, static_cast <long long> (cycles), max);
+        if (previous == max)
+            break;
+
+        max = previous;
+    }
+}
+
+template <std::size_t Capacity, std::size_t Depth>
+inline typename Windows::RwSpinLockTiming <Capacity, Depth>::Summary Windows::RwSpinLockTiming <Capacity, Depth>::Summarize (const Histogram & histogram) noexcept {
+    Summary summary = {};
+    for (auto n : histogram.buckets) {
+        summary.count += n;
+    }
+    summary.max = histogram.max;
+
+    if (summary.count) {
+        const auto r50 = (summary.count * 50 + 99) / 100;
+        const auto r99 = (summary.count * 99 + 99) / 100;
+
+        std::uint64_t cumulative = 0;
+        for (auto i = 0u; i != 64u; ++i) {
+            auto previous = cumulative;
+            cumulative += histogram.buckets [i];
+
+            auto bound = (i < 63) ? (2uLL << i) - 1 : ~0uLL;
+            if (bound > summary.max) {
+                bound = summary.max;
+            }
+            if (previous < r50 && cumulative >= r50) {
+                summary.p50 = bound;
+            }
+            if (previous < r99 && cumulative >= r99) {
+                summary.p99 = bound;
+            }
+        }
+    }
+    return summary;
+}
+
+template <std::size_t Capacity, std::size_t Depth>
+inline typename Windows::RwSpinLockTiming <Capacity, Depth>::Summary Windows::RwSpinLockTiming <Capacity, Depth>::Hold (const void * lock, RwSpinLockMode mode) noexcept {
+    if (auto entry = Registry::Find (lock))
+        return Summarize (entry->hold [(int) mode]);
+    else
+        return {};
+}
+
+template <std::size_t Capacity, std::size_t Depth>
+inline typename Windows::RwSpinLockTiming <Capacity, Depth>::Summary Windows::RwSpinLockTiming <Capacity, Depth>::Wait (const void * lock, RwSpinLockMode mode) noexcept {
+    if (auto entry = Registry::Find (lock))
+        return Summarize (entry->wait [(int) mode]);
+    else
+        return {};
+}
+
+template <std::size_t Capacity, std::size_t Depth>
+inline void Windows::RwSpinLockTiming <Capacity, Depth>::Reset () noexcept {
+    Registry::ForEach ([] (Timings & entry) {
+        for (auto histograms : { entry.hold, entry.wait }) {
+            for (auto i = 0u; i != 3u; ++i) {
+                for (auto & n : histograms [i].buckets) { InterlockedExchange64 (&n, 0); }
+                InterlockedExchange64 (&histograms [i].max, 0);
+            }
+        }
+    });
+}
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef WINDOWS_RWSPINLOCKTRACE_HPP
+#define WINDOWS_RWSPINLOCKTRACE_HPP
+
+#include "Windows_RwSpinLockStatistics.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+namespace Windows {
+
+    // RwSpinLockTrace
+    //  - Stats policy recording lock events into per-thread ring buffers, for post-mortem analysis of latency spikes
+    //  - every event carries RwSpinLockTimestamp and the lock address; only the owning thread writes the buffer
+    //    (RwSpinLockThreadBuffers), so recording is a few plain stores, without any interlocked instruction
+    //  - each buffer keeps last 'Events' events
+    //  - Export converts the buffers into Chrome trace JSON, viewable in chrome://tracing or ui.perfetto.dev
+    //  - usage: Windows::RwSpinLock <short, Windows::RwSpinLockTrace <>> lock;
+    //
+    template <std::size_t Events = 4096>
+    class RwSpinLockTrace {
+    public:
+
+        enum class Type : std::uint8_t {
+            Phase,          // waiting thread reached escalation phase, first one starts the wait
+            Acquired,       // acquisition or upgrade succeeded
+            Released,
+            Timeout,
+            UpgradeFailed,  // TryUpgradeToExclusive failed
+        };
+
+        struct Event {
+            std::uint64_t timestamp;
+            const void * lock;
+            std::uint32_t rounds;
+            Type type;
+            RwSpinLockMode mode;
+            RwSpinLockPhase phase;
+        };
+
+        // Enumerate
+        //  - calls 'f' (thread id, pointer to events, count) for every thread buffer, oldest events first
+        //  - events are copied first, buffers may be written concurrently, events overwritten during
+        //    the copy are discarded, as are buffers taken over by a new thread during the copy
+        //
+        template <typename F>
+        static inline void Enumerate (F && f);
+
+        // Export
+        //  - writes Chrome trace JSON ("traceEvents" array format) of all buffers into 'output'
+        //  - holds and waits are paired into complete events per thread, escalation phases, timeouts
+        //    and failed upgrades are instant events
+        //  - holds and waits that started before the oldest recorded event are not shown
+        //
+        static inline void Export (std::FILE * output);
+
+        // Clear
+        //  - discards all recorded events
+        //
+        static inline void Clear () noexcept;
+
+    public:
+
+        // Stats policy, see RwSpinLockNoStatistics
+
+        static inline void Acquired (const void * lock, RwSpinLockMode mode, std::uint32_t rounds) noexcept {
+            Record (Type::Acquired, lock, mode, RwSpinLockPhase::Pause, rounds);
+        }
+        static inline void Released (const void * lock, RwSpinLockMode mode) noexcept {
+            Record (Type::Released, lock, mode, RwSpinLockPhase::Pause, 0);
+        }
+        static inline void Phase (const void * lock, RwSpinLockMode mode, RwSpinLockPhase phase) noexcept {
+            Record (Type::Phase, lock, mode, phase, 0);
+        }
+        static inline void Timeout (const void * lock, RwSpinLockMode mode, std::uint32_t rounds) noexcept {
+            Record (Type::Timeout, lock, mode, RwSpinLockPhase::Pause, rounds);
+        }
+        static inline void UpgradeFailed (const void * lock) noexcept {
+            Record (Type::UpgradeFailed, lock, RwSpinLockMode::Upgrade, RwSpinLockPhase::Pause, 0);
+        }
+        static inline void Site (const void *, RwSpinLockMode, const RwSpinLockSite &) noexcept {}
+        static inline DWORD Owner (const void *) noexcept { return 0; }
+
+    private:
+
+        // Buffer
+        //  - ring buffer of a single thread, 'head' is total number of events ever written, written only by owner,
+        //    with release semantics so that the events below 'head' are visible to Enumerate
+        //  - 'cleared' is value of 'head' at the last Clear call
+        //
+        struct Buffer {
+            std::atomic <long long> head { 0 };
+            volatile long long cleared = 0;
+            Event events [Events];
+
+            inline void Reset () noexcept {
+                this->head.store (0, std::memory_order_relaxed);
+                this->cleared = 0;
+            }
+        };
+
+        using Buffers = RwSpinLockThreadBuffers <Buffer>;
+
+        static inline void Record (Type type, const void * lock, RwSpinLockMode mode, RwSpinLockPhase phase, std::uint32_t rounds) noexcept {
+            if (auto buffer = Buffers::Current ()) {
+                auto head = buffer->head.load (std::memory_order_relaxed);
+                auto & event = buffer->events [head % Events];
+                event.timestamp = RwSpinLockTimestamp ();
+                event.lock = lock;
+                event.rounds = rounds;
+                event.type = type;
+                event.mode = mode;
+                event.phase = phase;
+                buffer->head.store (head + 1, std::memory_order_release);
+            }
+        }
+    };
+}
+
+#include "Windows_RwSpinLockTrace.tcc"
+#endif
@@ -0,0 +1,140 @@
+#ifndef WINDOWS_RWSPINLOCKTRACE_TCC
+#define WINDOWS_RWSPINLOCKTRACE_TCC
+
+#include "Windows_RwSpinLockTrace.hpp"
+
+// RwSpinLockTrace
+
+// Enumerate
+//  - acquire load of 'head' pairs with the owner's release store, events below it are complete
+//  - events overwritten by the owner during the copy are discarded
+//
+template <std::size_t Events>
+template <typename F>
+inline void Windows::RwSpinLockTrace <Events>::Enumerate (F && f) {
+    std::vector <Event> events;
+    std::size_t skip = 0;
+    events.reserve (Events);
+
+    Buffers::Enumerate ([&events, &skip] (const Buffer & buffer) {
+        long long head = buffer.head.load (std::memory_order_acquire);
+        long long cleared = buffer.cleared;
+        long long first = std::max (head - (long long) Events, cleared);
+
+        events.clear ();
+        for (auto i = first; i < head; ++i) {
+            events.push_back (buffer.events [i % Events]);
+        }
+
+        // discard events the owner might have overwritten in the meantime, including the one being written
+        std::atomic_thread_fence (std::memory_order_acquire);
+        long long overwritten = buffer.head.load (std::memory_order_relaxed) - (long long) Events + 1;
+        skip = 0;
+        if (overwritten > first) {
+            skip = (std::size_t) std::min (overwritten - first, head - first);
+        }
+    }, [&events, &skip, &f] (DWORD thread) {
+        if (events.size () > skip) {
+            f (thread, events.data () + skip, events.size () - skip);
+        }
+    });
+}
+
+template <std::size_t Events>
+inline void Windows::RwSpinLockTrace <Events>::Export (std::FILE * output) {
+    static const char * const modes [] = { "exclusive", "shared", "upgrade" };
+    static const char * const phases [] = { "Pause", "Yield", "Sleep0", "Sleep1", "Park" };
+
+    struct Thread {
+        DWORD id;
+        std::vector <Event> events;
+    };
+    std::vector <Thread> threads;
+    std::uint64_t base = ~0uLL;
+
+    Enumerate ([&threads, &base] (DWORD id, const Event * events, std::size_t n) {
+        threads.push_back ({ id, std::vector <Event> (events, events + n) });
+        base = std::min (base, events [0].timestamp);
+    });
+
+    const auto pid = GetCurrentProcessId ();
+    const auto frequency = RwSpinLockTimestampFrequency () / 1000000.0; // units per microsecond
+    auto first = true;
+
+    auto emit = [&] (DWORD tid, const char * name, const char * suffix, std::uint64_t begin, std::uint64_t end, const Event & event) {
+        std::fprintf (output, "%s\n{\"name\":\"%s%s\",\"cat\":\"lock\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f,",
+                      first ? "" : ",", name, suffix, (unsigned) pid, (unsigned) tid, (begin - base) / frequency);
+        if (end != begin) {
+            std::fprintf (output, "\"ph\":\"X\",\"dur\":%.3f,", (end - begin) / frequency);
+        } else {
+            std::fprintf (output, "\"ph\":\"i\",\"s\":\"t\",");
+        }
+        std::fprintf (output, "\"args\":{\"lock\":\"%p\",\"rounds\":%u}}", event.lock, event.rounds);
+        first = false;
+    };
+
+    std::fprintf (output, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    for (const auto & thread : threads) {
+        std::vector <Event> held;
+        Event wait = {};
+
+        for (const auto & event : thread.events) {
+            switch (event.type) {
+                case Type::Phase:
+                    if (wait.lock != event.lock) {
+                        wait = event;
+                    }
+                    if (event.phase != RwSpinLockPhase::Pause) {
+                        emit (thread.id, phases [(int) event.phase], "", event.timestamp, event.timestamp, event);
+                    }
+                    break;
+
+                case Type::Acquired:
+                    if (wait.lock == event.lock) {
+                        emit (thread.id, "wait ", modes [(int) event.mode], wait.timestamp, event.timestamp, event);
+                        wait.lock = nullptr;
+                    }
+                    held.push_back (event);
+                    break;
+
+                case Type::Timeout:
+                    if (wait.lock == event.lock) {
+                        emit (thread.id, "wait ", modes [(int) event.mode], wait.timestamp, event.timestamp, event);
+                        wait.lock = nullptr;
+                    }
+                    emit (thread.id, "timeout ", modes [(int) event.mode], event.timestamp, event.timestamp, event);
+                    break;
+
+                case Type::Released:
+                    // ReleaseExclusive of upgraded lock releases also the shared lock it was upgraded from
+                    for (auto i = held.size (); i--; ) {
+                        if (held [i].lock == event.lock) {
+                            auto h = held [i];
+                            held.erase (held.begin () + i);
+                            emit (thread.id, modes [(int) h.mode], "", h.timestamp, event.timestamp, h);
+
+                            if (h.mode == RwSpinLockMode::Upgrade && event.mode == RwSpinLockMode::Exclusive)
+                                continue;
+
+                            break;
+                        }
+                    }
+                    break;
+
+                case Type::UpgradeFailed:
+                    emit (thread.id, "upgrade failed", "", event.timestamp, event.timestamp, event);
+                    break;
+            }
+        }
+    }
+    std::fprintf (output, "\n]}\n");
+}
+
+template <std::size_t Events>
+inline void Windows::RwSpinLockTrace <Events>::Clear () noexcept {
+    Buffers::ForEach ([] (Buffer & buffer) {
+        InterlockedExchange64 (&buffer.cleared, buffer.head.load (std::memory_order_acquire));
+    });
+}
+
+#endif
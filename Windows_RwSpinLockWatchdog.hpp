@@ -0,0 +1,124 @@
+#ifndef WINDOWS_RWSPINLOCKWATCHDOG_HPP
+#define WINDOWS_RWSPINLOCKWATCHDOG_HPP
+
+#include "Windows_RwSpinLockStatistics.hpp"
+#include <cstddef>
+
+namespace Windows {
+
+    // RwSpinLockWatchdog
+    //  - Stats policy stamping owner thread id and acquisition time of every exclusive (or upgraded) lock,
+    //    and a background thread reporting locks held longer than a threshold, e.g. I/O under spin lock
+    //  - each overlong hold is reported once, while still being held
+    //  - shared locks are not tracked, the owners of cross-process locks are tracked only in the process
+    //    that runs the watchdog thread
+    //  - Capacity - maximum number of distinct locks tracked, see RwSpinLockRegistry
+    //  - usage: Windows::RwSpinLock <short, Windows::RwSpinLockWatchdog <>> lock;
+    //           Windows::RwSpinLockWatchdog <>::Start (50);
+    //
+    template <std::size_t Capacity = 1024>
+    class RwSpinLockWatchdog {
+    public:
+
+        // Report
+        //  - lock held for 'held' milliseconds by thread 'owner' of this process
+        //
+        struct Report {
+            const void * lock;
+            DWORD owner;
+            std::uint64_t held;
+        };
+
+        // Callback
+        //  - called from the watchdog thread, the owner thread may have released the lock in the meantime
+        //  - null callback (default) prints the report and owner's backtrace via OutputDebugString
+        //
+        using Callback = void (*) (const Report & report, void * context);
+
+        // Start
+        //  - starts the watchdog thread, scanning all locks every 'period' ms
+        //  - threshold - report holds longer than this, in milliseconds
+        //  - returns false if already running or the thread couldn't be started
+        //
+        static inline bool Start (std::uint64_t threshold, Callback callback = nullptr, void * context = nullptr, DWORD period = 10) noexcept;
+
+        // Stop
+        //  - stops the watchdog thread and waits for it to exit
+        //
+        static inline void Stop () noexcept;
+
+        // Backtrace
+        //  - backtrace hook for in-process owners: suspends 'thread', captures up to 'capacity' return addresses
+        //    of its stack into 'frames', and resumes the thread, returns number of frames captured
+        //  - x64 only, returns 0 elsewhere, or if the thread can't be suspended (e.g. already exited)
+        //  - NOTE: unwinding consults function tables under the loader's locks, calling this on thread
+        //          that is loading or unloading a module will deadlock
+        //
+        static inline std::size_t Backtrace (DWORD thread, void ** frames, std::size_t capacity) noexcept;
+
+    public:
+
+        // Stats policy, see RwSpinLockNoStatistics
+
+        static inline void Acquired (const void * lock, RwSpinLockMode mode, std::uint32_t) noexcept {
+            if (mode != RwSpinLockMode::Shared) {
+                InterlockedExchange64 (&Registry::Entry (lock)->hold, Pack (GetCurrentThreadId (), GetTickCount64 ()));
+            }
+        }
+        static inline void Released (const void * lock, RwSpinLockMode mode) noexcept {
+            if (mode != RwSpinLockMode::Shared) {
+                InterlockedExchange64 (&Registry::Entry (lock)->hold, 0);
+            }
+        }
+        static inline void Phase (const void *, RwSpinLockMode, RwSpinLockPhase) noexcept {}
+        static inline void Timeout (const void *, RwSpinLockMode, std::uint32_t) noexcept {}
+        static inline void UpgradeFailed (const void *) noexcept {}
+        static inline void Site (const void *, RwSpinLockMode, const RwSpinLockSite &) noexcept {}
+        static inline DWORD Owner (const void * lock) noexcept {
+            auto record = Registry::Find (lock);
+            return record ? Owner (Read (record->hold)) : 0;
+        }
+
+    private:
+
+        // Record
+        //  - 'hold' packs owner thread id (upper half) and low 32 bits of GetTickCount64 at acquisition (lower half)
+        //    into single interlocked word, so that the watchdog never pairs owner of one hold with time of another;
+        //    0 while not held exclusively, holds over 49 days are not measured correctly
+        //  - 'reported' is 'hold' of the last reported hold
+        //
+        struct Record {
+            const void * volatile lock;
+            volatile long long hold;
+            long long reported;
+        };
+
+        using Registry = RwSpinLockRegistry <Record, Capacity>;
+
+        static inline long long Pack (DWORD owner, std::uint64_t since) noexcept {
+            return (long long) (((std::uint64_t) owner << 32) | (DWORD) since);
+        }
+        static inline DWORD Owner (long long hold) noexcept {
+            return (DWORD) ((std::uint64_t) hold >> 32);
+        }
+        static inline DWORD Since (long long hold) noexcept {
+            return (DWORD) hold;
+        }
+        static inline long long Read (const volatile long long & hold) noexcept {
+            return InterlockedCompareExchange64 (const_cast <volatile long long *> (&hold), 0, 0); // atomic read, also on 32-bit
+        }
+
+        static inline DWORD WINAPI Procedure (LPVOID) noexcept;
+        static inline void Print (const Report & report) noexcept;
+
+        static inline HANDLE thread = NULL;
+        static inline HANDLE stop = NULL;
+        static inline std::uint64_t threshold = 0;
+        static inline Callback callback = nullptr;
+        static inline void * context = nullptr;
+        static inline DWORD period = 10;
+    };
+}
+
+#include "Windows_RwSpinLockWatchdog.tcc"
+#endif
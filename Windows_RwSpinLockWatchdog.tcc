@@ -0,0 +1,129 @@
+#ifndef WINDOWS_RWSPINLOCKWATCHDOG_TCC
+#define WINDOWS_RWSPINLOCKWATCHDOG_TCC
+
+#include "Windows_RwSpinLockWatchdog.hpp"
+#include <cstdio>
+
+// RwSpinLockWatchdog
+
+template <std::size_t Capacity>
+inline bool Windows::RwSpinLockWatchdog <Capacity>::Start (std::uint64_t threshold, Callback callback, void * context, DWORD period) noexcept {
+    if (RwSpinLockWatchdog::thread)
+        return false;
+
+    RwSpinLockWatchdog::threshold = threshold;
+    RwSpinLockWatchdog::callback = callback;
+    RwSpinLockWatchdog::context = context;
+    RwSpinLockWatchdog::period = period;
+
+    if ((RwSpinLockWatchdog::stop = CreateEvent (NULL, TRUE, FALSE, NULL)) != NULL) {
+        if ((RwSpinLockWatchdog::thread = CreateThread (NULL, 0, &RwSpinLockWatchdog::Procedure, NULL, 0, NULL)) != NULL)
+            return true;
+
+        CloseHandle (RwSpinLockWatchdog::stop);
+        RwSpinLockWatchdog::stop = NULL;
+    }
+    return false;
+}
+
+template <std::size_t Capacity>
+inline void Windows::RwSpinLockWatchdog <Capacity>::Stop () noexcept {
+    if (RwSpinLockWatchdog::thread) {
+        SetEvent (RwSpinLockWatchdog::stop);
+        WaitForSingleObject (RwSpinLockWatchdog::thread, INFINITE);
+
+        CloseHandle (RwSpinLockWatchdog::thread);
+        CloseHandle (RwSpinLockWatchdog::stop);
+        RwSpinLockWatchdog::thread = NULL;
+        RwSpinLockWatchdog::stop = NULL;
+    }
+}
+
+// Procedure
+//  - owner and acquisition time are read together, as single interlocked word
+//
+template <std::size_t Capacity>
+inline DWORD WINAPI Windows::RwSpinLockWatchdog <Capacity>::Procedure (LPVOID) noexcept {
+    while (WaitForSingleObject (RwSpinLockWatchdog::stop, RwSpinLockWatchdog::period) == WAIT_TIMEOUT) {
+        const auto now = GetTickCount64 ();
+
+        Registry::ForEach ([now] (Record & record) {
+            if (record.lock == nullptr)
+                return;
+
+            const auto hold = Read (record.hold);
+            if (hold == 0 || hold == record.reported)
+                return;
+
+            const auto held = (DWORD) now - Since (hold); // modulo 2^32
+            if (held > RwSpinLockWatchdog::threshold) {
+                record.reported = hold;
+
+                Report report = { record.lock, Owner (hold), held };
+                if (RwSpinLockWatchdog::callback) {
+                    RwSpinLockWatchdog::callback (report, RwSpinLockWatchdog::context);
+                } else {
+                    Print (report);
+                }
+            }
+        });
+    }
+    return 0;
+}
+
+template <std::size_t Capacity>
+inline void Windows::RwSpinLockWatchdog <Capacity>::Print (const Report & report) noexcept {
+    char text [128];
+    std::snprintf (text, sizeof text, "RwSpinLock %p held exclusively by thread %u for %llu ms\n",
+                   report.lock, (unsigned int) report.owner, (unsigned long long) report.held);
+    OutputDebugStringA (text);
+
+    void * frames [32];
+    auto n = Backtrace (report.owner, frames, sizeof frames / sizeof frames [0]);
+    for (std::size_t i = 0; i != n; ++i) {
+        std::snprintf (text, sizeof text, "  #%u %p\n", (unsigned int) i, frames [i]);
+        OutputDebugStringA (text);
+    }
+}
+
+template <std::size_t Capacity>
+inline std::size_t Windows::RwSpinLockWatchdog <Capacity>::Backtrace (DWORD id, void ** frames, std::size_t capacity) noexcept {
+    std::size_t n = 0;
+#if defined (_M_AMD64) && !defined (_M_ARM64EC)
+    if (id == GetCurrentThreadId ())
+        return RtlCaptureStackBackTrace (0, (DWORD) capacity, frames, NULL);
+
+    if (auto h = OpenThread (THREAD_SUSPEND_RESUME | THREAD_GET_CONTEXT | THREAD_QUERY_INFORMATION, FALSE, id)) {
+        if (SuspendThread (h) != (DWORD) -1) {
+
+            CONTEXT context = {};
+            context.ContextFlags = CONTEXT_CONTROL | CONTEXT_INTEGER;
+            if (GetThreadContext (h, &context)) {
+                while (n != capacity && context.Rip) {
+                    frames [n++] = reinterpret_cast <void *> (context.Rip);
+
+                    DWORD64 base = 0;
+                    if (auto function = RtlLookupFunctionEntry (context.Rip, &base, NULL)) {
+                        PVOID data = nullptr;
+                        DWORD64 frame = 0;
+                        RtlVirtualUnwind (UNW_FLAG_NHANDLER, base, context.Rip, function, &context, &data, &frame, NULL);
+                    } else {
+                        // leaf function, return address is on top of the stack
+                        context.Rip = *reinterpret_cast <DWORD64 *> (context.Rsp);
+                        context.Rsp += 8;
+                    }
+                }
+            }
+            ResumeThread (h);
+        }
+        CloseHandle (h);
+    }
+#else
+    (void) id;
+    (void) frames;
+    (void) capacity;
+#endif
+    return n;
+}
+
+#endif